@@ -1,13 +1,112 @@
 ﻿#include "Audio/DialogueVoiceList.h"
-#include "Core/Log.h"
+#include "Misc/DataValidation.h"
 
 /**
  * @brief Get a random audio file from the array of available audio files
- * @return A random audio file from the array of available audio files
+ * @return A random audio file or nullptr if there are no audio files
  */
-USoundBase* UDialogueVoiceList::GetRandomVoice()
+USoundBase* UDialogueVoiceList::GetRandomVoice() const
 {
-	const int Index = FMath::RandRange(0, Voices.Num() - 1);
-	ULog::Info("DialogueVoiceList::GetRandomVoice", FString("Index = ").Append(FString::FromInt(Index)));
-	return Voices[Index];
-}
\ No newline at end of file
+	return Voices.Num() == 0 ? nullptr : Voices[FMath::RandRange(0, Voices.Num() - 1)];
+}
+
+/**
+ * @brief Get the weight of the specified audio file when using weighted selection
+ * @param VoiceIndex The index of the audio file
+ * @return The weight of the audio file
+ */
+float UDialogueVoiceList::GetWeight(const int VoiceIndex) const
+{
+	return Weights.IsValidIndex(VoiceIndex) ? FMath::Max(Weights[VoiceIndex], 0.0f) : 1.0f;
+}
+
+/**
+ * @brief Get the word timing markers of the specified audio file
+ * @param VoiceIndex The index of the audio file
+ * @return The word timing markers or nullptr if the audio file has no markers
+ */
+const TArray<float>* UDialogueVoiceList::GetWordTimings(const int VoiceIndex) const
+{
+	if (!WordTimings.IsValidIndex(VoiceIndex) || WordTimings[VoiceIndex].WordStartTimes.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	return &WordTimings[VoiceIndex].WordStartTimes;
+}
+
+#if WITH_EDITOR
+/**
+ * @brief Validate the voice files. Used by the editor data validation and the dialogue validation commandlet
+ * @param ValidationErrors The errors found while validating the data
+ * @return The result of the validation
+ */
+EDataValidationResult UDialogueVoiceList::IsDataValid(TArray<FText>& ValidationErrors)
+{
+	const EDataValidationResult Result = Super::IsDataValid(ValidationErrors);
+	const int NumErrors = ValidationErrors.Num();
+
+	if (VoiceMode == EDialogueVoiceMode::Blips)
+	{
+		if (BlipProfile.Sound == nullptr)
+		{
+			ValidationErrors.Add(FText::FromString("The voice list uses blips but has no blip sound"));
+		}
+
+		if (BlipProfile.MinPitch > BlipProfile.MaxPitch)
+		{
+			ValidationErrors.Add(FText::FromString("The minimum blip pitch is higher than the maximum blip pitch"));
+		}
+
+		if (Voices.Num() > 0)
+		{
+			ValidationErrors.Add(FText::FromString("The voice list uses blips, so the audio files are loaded but never played"));
+		}
+	}
+	else if (Voices.Num() == 0)
+	{
+		ValidationErrors.Add(FText::FromString("The voice list has no audio files"));
+	}
+
+	float TotalWeight = 0.0f;
+	for (int VoiceIndex = 0; VoiceIndex < Voices.Num(); VoiceIndex++)
+	{
+		TotalWeight += GetWeight(VoiceIndex);
+		if (Voices[VoiceIndex] == nullptr)
+		{
+			ValidationErrors.Add(FText::FromString(FString::Printf(TEXT("Audio file %d is not set"), VoiceIndex)));
+			continue;
+		}
+
+		const TArray<float>* WordStartTimes = GetWordTimings(VoiceIndex);
+		const float Duration = Voices[VoiceIndex]->GetDuration();
+		for (int Word = 0; WordStartTimes != nullptr && Word < WordStartTimes->Num(); Word++)
+		{
+			const float StartTime = (*WordStartTimes)[Word];
+			if ((Word > 0 && StartTime < (*WordStartTimes)[Word - 1]) || StartTime < 0.0f || StartTime > Duration)
+			{
+				ValidationErrors.Add(FText::FromString(FString::Printf(
+					TEXT("Word timing %d of audio file %d is out of order or outside the audio file"), Word, VoiceIndex)));
+				break;
+			}
+		}
+	}
+
+	if (Weights.Num() > Voices.Num() || WordTimings.Num() > Voices.Num())
+	{
+		ValidationErrors.Add(FText::FromString("The voice list has more weights or word timings than audio files"));
+	}
+
+	if (SelectionMode == EDialogueVoiceSelection::Weighted && Voices.Num() > 0 && TotalWeight <= 0.0f)
+	{
+		ValidationErrors.Add(FText::FromString("Weighted selection is used but every weight is 0"));
+	}
+
+	if (ValidationErrors.Num() > NumErrors)
+	{
+		return EDataValidationResult::Invalid;
+	}
+
+	return Result == EDataValidationResult::NotValidated ? EDataValidationResult::Valid : Result;
+}
+#endif
\ No newline at end of file
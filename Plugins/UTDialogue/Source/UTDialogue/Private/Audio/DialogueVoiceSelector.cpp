@@ -0,0 +1,144 @@
+﻿#include "Audio/DialogueVoiceSelector.h"
+#include "Audio/DialogueVoiceList.h"
+
+/**
+ * @brief Create a selector
+ * @param Seed The seed of the random stream
+ */
+FDialogueVoiceSelector::FDialogueVoiceSelector(const int Seed)
+	: Random(Seed)
+{
+}
+
+/**
+ * @brief Change the seed of the random stream and forget the voice files that were selected
+ * @param Seed The seed of the random stream
+ */
+void FDialogueVoiceSelector::Reset(const int Seed)
+{
+	Random.Initialize(Seed);
+	States.Reset();
+}
+
+/**
+ * @brief Select a voice file using the selection mode of the voice list
+ * @param VoiceList The voice list to select from
+ * @return The index of the selected voice file or -1 if the voice list has no voice files
+ */
+int FDialogueVoiceSelector::SelectVoice(const UDialogueVoiceList* VoiceList)
+{
+	const int NumVoices = VoiceList != nullptr ? VoiceList->Voices.Num() : 0;
+	if (NumVoices == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	FVoiceListState& State = States.FindOrAdd(VoiceList);
+	switch (VoiceList->SelectionMode)
+	{
+	case EDialogueVoiceSelection::ShuffleBag:
+		State.Last = DrawFromBag(State, NumVoices);
+		break;
+	case EDialogueVoiceSelection::Weighted:
+		State.Last = SelectWeighted(VoiceList);
+		break;
+	case EDialogueVoiceSelection::Sequential:
+		State.Last = (State.Last + 1) % NumVoices;
+		break;
+	default:
+		State.Last = Random.RandRange(0, NumVoices - 1);
+		break;
+	}
+
+	return State.Last;
+}
+
+/**
+ * @brief Select the pitch of a blip using the random stream, so replays produce the same blips
+ * @param Profile The speaker profile of the blip
+ * @param Character The letter that is voiced by the blip
+ * @return The pitch multiplier of the blip
+ */
+float FDialogueVoiceSelector::SelectBlipPitch(const FDialogueBlipProfile& Profile, const TCHAR Character)
+{
+	if (!Profile.PitchFromCharacter)
+	{
+		return Random.FRandRange(Profile.MinPitch, Profile.MaxPitch);
+	}
+
+	const uint32 Hash = static_cast<uint32>(FChar::ToLower(Character)) * 2654435761u;
+	return FMath::Lerp(Profile.MinPitch, Profile.MaxPitch, static_cast<float>(Hash >> 16) / 65535.0f);
+}
+
+/**
+ * @brief Draw the next voice file from the shuffle bag. The bag is refilled when it is empty
+ * @param State The selection state of the voice list
+ * @param NumVoices The number of voice files in the voice list
+ * @return The index of the selected voice file
+ */
+int FDialogueVoiceSelector::DrawFromBag(FVoiceListState& State, const int NumVoices)
+{
+	State.Bag.RemoveAll([NumVoices](const int VoiceIndex) { return VoiceIndex >= NumVoices; });
+	if (State.Bag.Num() == 0)
+	{
+		State.Bag.SetNumUninitialized(NumVoices);
+		for (int VoiceIndex = 0; VoiceIndex < NumVoices; VoiceIndex++)
+		{
+			State.Bag[VoiceIndex] = VoiceIndex;
+		}
+
+		for (int VoiceIndex = NumVoices - 1; VoiceIndex > 0; VoiceIndex--)
+		{
+			State.Bag.Swap(VoiceIndex, Random.RandRange(0, VoiceIndex));
+		}
+
+		// The first voice file of a new bag must not repeat the last voice file of the previous bag
+		if (NumVoices > 1 && State.Bag.Last() == State.Last)
+		{
+			State.Bag.Swap(NumVoices - 1, Random.RandRange(0, NumVoices - 2));
+		}
+	}
+
+	return State.Bag.Pop(false);
+}
+
+/**
+ * @brief Select a voice file using the weights of the voice list
+ * @param VoiceList The voice list to select from
+ * @return The index of the selected voice file
+ */
+int FDialogueVoiceSelector::SelectWeighted(const UDialogueVoiceList* VoiceList)
+{
+	const int NumVoices = VoiceList->Voices.Num();
+	float TotalWeight = 0.0f;
+	for (int VoiceIndex = 0; VoiceIndex < NumVoices; VoiceIndex++)
+	{
+		TotalWeight += VoiceList->GetWeight(VoiceIndex);
+	}
+
+	if (TotalWeight <= 0.0f)
+	{
+		return Random.RandRange(0, NumVoices - 1);
+	}
+
+	float Remaining = Random.FRandRange(0.0f, TotalWeight);
+	for (int VoiceIndex = 0; VoiceIndex < NumVoices; VoiceIndex++)
+	{
+		Remaining -= VoiceList->GetWeight(VoiceIndex);
+		if (Remaining < 0.0f)
+		{
+			return VoiceIndex;
+		}
+	}
+
+	// Rounding can leave a tiny remainder, so fall back to the last voice file with a weight
+	for (int VoiceIndex = NumVoices - 1; VoiceIndex > 0; VoiceIndex--)
+	{
+		if (VoiceList->GetWeight(VoiceIndex) > 0.0f)
+		{
+			return VoiceIndex;
+		}
+	}
+
+	return 0;
+}
\ No newline at end of file
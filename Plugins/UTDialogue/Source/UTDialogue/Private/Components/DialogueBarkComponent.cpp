@@ -0,0 +1,101 @@
+﻿#include "Components/DialogueBarkComponent.h"
+#include "Core/DialogueBarkManager.h"
+#include "Core/Log.h"
+#include "Kismet/GameplayStatics.h"
+
+UDialogueBarkComponent::UDialogueBarkComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	Importance = 1.0f;
+	AutoBark = true;
+	MinBarkInterval = 8.0f;
+	MaxBarkInterval = 20.0f;
+	MinDisplayTime = 2.0f;
+	DisplayTimePerCharacter = 0.05f;
+	BarkManager = nullptr;
+	SpeakerIndex = INDEX_NONE;
+}
+
+/**
+ * @brief Begins Play for the component
+ */
+void UDialogueBarkComponent::BeginPlay()
+{
+	Super::BeginPlay();
+	const int Seed = VoiceSeed != 0 ? VoiceSeed : FMath::Rand();
+	VoiceSelector.Reset(Seed);
+	BarkRandom.Initialize(Seed);
+
+	BarkManager = dynamic_cast<ADialogueBarkManager*>(
+		UGameplayStatics::GetActorOfClass(GetWorld(), ADialogueBarkManager::StaticClass()));
+	if (BarkManager == nullptr)
+	{
+		ULog::Error("DialogueBarkComponent::BeginPlay", "BarkManager is nullptr");
+		return;
+	}
+
+	BarkManager->RegisterSpeaker(this);
+}
+
+/**
+ * @brief Ends gameplay for this component
+ * @param EndPlayReason The reason why gameplay is ending
+ */
+void UDialogueBarkComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (BarkManager != nullptr)
+	{
+		BarkManager->UnregisterSpeaker(this);
+		BarkManager = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * @brief Request a bark from the bark manager. The bark is only played if the scheduler has budget for it
+ * @param LineIndex The index of the line to play or -1 to play a random line
+ */
+void UDialogueBarkComponent::RequestBark(const int LineIndex)
+{
+	if (BarkManager == nullptr)
+	{
+		ULog::Error("DialogueBarkComponent::RequestBark", "BarkManager is nullptr");
+		return;
+	}
+
+	BarkManager->RequestBark(this, LineIndex);
+}
+
+/**
+ * @brief Get the time in seconds the specified line should be displayed
+ * @param LineIndex The index of the line
+ * @return The time in seconds the specified line should be displayed
+ */
+float UDialogueBarkComponent::GetDisplayTime(const int LineIndex) const
+{
+	if (!BarkLines.IsValidIndex(LineIndex))
+	{
+		return MinDisplayTime;
+	}
+
+	return FMath::Max(MinDisplayTime, BarkLines[LineIndex].ToString().Len() * DisplayTimePerCharacter);
+}
+
+/**
+ * @brief Get a random time in seconds until the next automatic bark
+ * @return A random time in seconds until the next automatic bark
+ */
+float UDialogueBarkComponent::GetRandomBarkInterval() const
+{
+	return BarkRandom.FRandRange(MinBarkInterval, FMath::Max(MinBarkInterval, MaxBarkInterval));
+}
+
+/**
+ * @brief Get the index of a random bark line
+ * @return The index of a random bark line or -1 if the speaker has no bark lines
+ */
+int UDialogueBarkComponent::GetRandomBarkLine() const
+{
+	return BarkLines.Num() > 0 ? BarkRandom.RandRange(0, BarkLines.Num() - 1) : INDEX_NONE;
+}
\ No newline at end of file
@@ -1,8 +1,12 @@
 ﻿#include "Components/DialogueTrigger.h"
+#include "Async/Async.h"
 #include "Blueprint/UserWidget.h"
 #include "Blueprint/WidgetBlueprintLibrary.h"
 #include "Core/DialogueManager.h"
+#include "Core/DialogueSubsystem.h"
 #include "Core/Log.h"
+#include "Internationalization/Internationalization.h"
+#include "Misc/DataValidation.h"
 
 /**
  * @brief Begins Play for the component
@@ -21,6 +25,45 @@ void UDialogueTrigger::BeginPlay()
 	ULog::Info("DialogueTrigger::BeginPlay", "Binding to overlap events");
 	Owner->OnActorBeginOverlap.AddDynamic(this, &UDialogueTrigger::OnActorBeginOverlap);
 	Owner->OnActorEndOverlap.AddDynamic(this, &UDialogueTrigger::OnActorEndOverlap);
+
+	// The manager might begin play later, in which case it registers this trigger itself
+	if (GetDialogueManager() == nullptr)
+	{
+		ULog::Info("DialogueTrigger::BeginPlay", "No DialogueManager to register with yet");
+	}
+
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (DialogueSubsystem == nullptr)
+	{
+		ULog::Error("DialogueTrigger::BeginPlay", "DialogueSubsystem is nullptr");
+		return;
+	}
+
+	DialogueSubsystem->RegisterConversation(this);
+}
+
+/**
+ * @brief Ends gameplay for this component
+ * @param EndPlayReason The reason why gameplay is ending
+ */
+void UDialogueTrigger::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	AActor* Owner = GetOwner();
+	if (Owner != nullptr)
+	{
+		ULog::Info("DialogueTrigger::EndPlay", "Unbinding from overlap events");
+		Owner->OnActorBeginOverlap.RemoveDynamic(this, &UDialogueTrigger::OnActorBeginOverlap);
+		Owner->OnActorEndOverlap.RemoveDynamic(this, &UDialogueTrigger::OnActorEndOverlap);
+	}
+
+	if (ADialogueManager* Manager = DialogueManager.Get())
+	{
+		Manager->UnregisterDialogueTrigger(this);
+	}
+
+	CancelPreparation();
+	CancelProvidedLines();
+	Super::EndPlay(EndPlayReason);
 }
 
 /**
@@ -35,7 +78,68 @@ void UDialogueTrigger::ShowDialogue()
 		return;
 	}
 
-	DialogueWidget->Show(DialogueTitles, DialogueMessages, DialogueVoices);
+	DialogueWidget->ShowPrepared(GetConversationHandle(), GetPreparedConversation(), DialogueVoices);
+
+	// The widget keeps its own reference, so a trigger shown without entering it does not hold the text
+	if (!PlayerInside)
+	{
+		CancelPreparation();
+	}
+}
+
+/**
+ * @brief Start preparing the text of the conversation on a background task. Called when the player enters the
+ * trigger. Call it again after changing the dialogue properties while the player is inside the trigger
+ */
+void UDialogueTrigger::PrepareDialogue()
+{
+	CancelPreparation();
+
+	// The task only works on a copy, so the trigger can be changed or destroyed while it runs
+	TSharedRef<std::atomic<bool>, ESPMode::ThreadSafe> Cancelled =
+		MakeShared<std::atomic<bool>, ESPMode::ThreadSafe>(false);
+	PreparationCancelled = Cancelled;
+	PreparedSource = MakePreparationSource();
+	PreparationTask = Async(EAsyncExecution::TaskGraph, [Source = PreparedSource, Cancelled]() mutable
+	{
+		return FDialoguePreparedConversation::Prepare(MoveTemp(Source), &Cancelled.Get());
+	});
+}
+
+/**
+ * @brief Cancel the background preparation and release the prepared text
+ */
+void UDialogueTrigger::CancelPreparation()
+{
+	if (PreparationCancelled.IsValid())
+	{
+		PreparationCancelled->store(true);
+		PreparationCancelled.Reset();
+	}
+
+	PreparationTask = TFuture<TSharedPtr<const FDialoguePreparedConversation, ESPMode::ThreadSafe>>();
+	PreparedConversation.Reset();
+	PreparedSource = FDialoguePreparationSource();
+}
+
+/**
+ * @brief Copy the data used to prepare the conversation. Must be called on the game thread
+ * @return The data used to prepare the conversation
+ */
+FDialoguePreparationSource UDialogueTrigger::MakePreparationSource() const
+{
+	FDialoguePreparationSource Source;
+	Source.Titles = DialogueTitles;
+	Source.Messages = DialogueMessages;
+	Source.Choices = DialogueChoices;
+	Source.Cues = DialogueCues;
+	for (const TPair<FString, FText>& Argument : DialogueArguments)
+	{
+		Source.Arguments.Add(Argument.Key, Argument.Value);
+	}
+
+	Source.Culture = FInternationalization::Get().GetCurrentCulture()->GetName();
+	return Source;
 }
 
 /**
@@ -68,6 +172,84 @@ void UDialogueTrigger::HideInteractWidget()
 	InteractWidget->HideWidget(true);
 }
 
+/**
+ * @brief Get the handle of the conversation in the dialogue subsystem. The handle can change after loading a save
+ * @return The handle of the conversation or -1 if the dialogue subsystem is not available
+ */
+int UDialogueTrigger::GetConversationHandle()
+{
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	return DialogueSubsystem == nullptr ? INDEX_NONE : DialogueSubsystem->RegisterConversation(this);
+}
+
+/**
+ * @brief Request the specified line and the next lines from the line provider without waiting for them
+ * @param FirstLine The index of the first line to request
+ */
+void UDialogueTrigger::PrefetchProvidedLines(const int FirstLine)
+{
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (LineProvider == nullptr || DialogueSubsystem == nullptr)
+	{
+		return;
+	}
+
+	FDialogueLineRequest Request;
+	Request.ConversationId = GetConversationId();
+	Request.Context = LineContext;
+	Request.Culture = FName(*FInternationalization::Get().GetCurrentCulture()->GetName());
+
+	const int LastLine = FMath::Min(FirstLine + PrefetchLineCount, DialogueMessages.Num() - 1);
+	for (int Line = FMath::Max(FirstLine, 0); Line <= LastLine; Line++)
+	{
+		Request.Line = Line;
+		Request.Title = DialogueTitles.IsValidIndex(Line) ? DialogueTitles[Line] : FText::GetEmpty();
+		Request.FallbackMessage = DialogueMessages[Line];
+		DialogueSubsystem->GetLinePrefetcher().Prefetch(LineProvider, Request);
+	}
+}
+
+/**
+ * @brief Get the message of a line from the line provider if it is available
+ * @param Line The index of the line
+ * @param OutMessage The provided message. Empty if the provider did not replace the static message
+ * @return A boolean value indicating if the line provider responded
+ */
+bool UDialogueTrigger::TryGetProvidedLine(const int Line, FText& OutMessage)
+{
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (LineProvider == nullptr || DialogueSubsystem == nullptr)
+	{
+		return false;
+	}
+
+	// Lines provided in the previous culture are not used after the culture changed
+	const FDialogueLineKey Key{GetConversationId(), Line, LineContext,
+		FName(*FInternationalization::Get().GetCurrentCulture()->GetName())};
+	return DialogueSubsystem->GetLinePrefetcher().TryGetLine(Key, OutMessage);
+}
+
+/**
+ * @brief Forget the requests to the line provider that were not used yet
+ */
+void UDialogueTrigger::CancelProvidedLines()
+{
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (LineProvider != nullptr && DialogueSubsystem != nullptr)
+	{
+		DialogueSubsystem->GetLinePrefetcher().CancelRequests(GetConversationId());
+	}
+}
+
+/**
+ * @brief Get the stable ID of the conversation
+ * @return The stable ID of the conversation
+ */
+FName UDialogueTrigger::GetConversationId() const
+{
+	return ConversationId.IsNone() ? FName(*GetPathName()) : ConversationId;
+}
+
 /**
  * @brief Called when another actor begins to overlap the parent actor
  * @param OverlappedActor The actor that triggered the overlap event
@@ -87,17 +269,18 @@ void UDialogueTrigger::OnActorBeginOverlap(AActor* OverlappedActor, AActor* Othe
 		return;
 	}
 	
-	ADialogueManager* DialogueManager = dynamic_cast<ADialogueManager*>(
-		UGameplayStatics::GetActorOfClass(GetWorld(), ADialogueManager::StaticClass()));
-	if (DialogueManager == nullptr)
+	ADialogueManager* Manager = GetDialogueManager();
+	if (Manager == nullptr)
 	{
 		ULog::Error("DialogueTrigger::OnActorBeginOverlap", "DialogueManager is nullptr");
 		return;
 	}
 
 	ULog::Trace("DialogueTrigger::OnActorBeginOverlap", "Showing the interact widget");
-	DialogueManager->SetCurrentDialogueTrigger(this);
+	PlayerInside = true;
+	Manager->SetCurrentDialogueTrigger(this);
 	ShowInteractWidget();
+	PrepareDialogue();
 }
 
 /**
@@ -119,17 +302,168 @@ void UDialogueTrigger::OnActorEndOverlap(AActor* OverlappedActor, AActor* OtherA
 		return;
 	}
 
-	ADialogueManager* DialogueManager = dynamic_cast<ADialogueManager*>(
-		UGameplayStatics::GetActorOfClass(GetWorld(), ADialogueManager::StaticClass()));
-	if (DialogueManager == nullptr)
+	ADialogueManager* Manager = GetDialogueManager();
+	if (Manager == nullptr)
 	{
 		ULog::Error("DialogueTrigger::OnActorEndOverlap", "DialogueManager is nullptr");
 		return;
 	}
 
-	ULog::Trace("DialogueTrigger::OnActorEndOverlap", "Hiding the interact widget");
-	DialogueManager->ResetDialogueTrigger(this);
-	HideInteractWidget();
+	ULog::Trace("DialogueTrigger::OnActorEndOverlap", "Resetting the dialogue trigger");
+	PlayerInside = false;
+	Manager->ResetDialogueTrigger(this);
+	CancelPreparation();
+
+	// A conversation that is shown continues after the player left, so it keeps its requests until it is dismissed
+	const UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (DialogueSubsystem == nullptr || DialogueSubsystem->GetActiveState().Conversation != GetConversationHandle())
+	{
+		CancelProvidedLines();
+	}
+}
+
+/**
+ * @brief Get the dialogue manager this trigger is registered with. Registers with the manager of the world if the
+ * trigger is not registered yet
+ * @return The dialogue manager or nullptr if the world has no dialogue manager
+ */
+ADialogueManager* UDialogueTrigger::GetDialogueManager()
+{
+	if (ADialogueManager* Manager = DialogueManager.Get())
+	{
+		return Manager;
+	}
+
+	// The previous manager ended play or no manager existed when this trigger began play
+	ADialogueManager* Manager = ADialogueManager::Get(this);
+	if (Manager != nullptr && ManagerIndex == INDEX_NONE)
+	{
+		Manager->RegisterDialogueTrigger(this);
+	}
+
+	return Manager;
+}
+
+/**
+ * @brief Get the prepared conversation. Uses the result of the preparation task when it is finished and prepares the
+ * conversation on the game thread otherwise
+ * @return The prepared conversation
+ */
+TSharedRef<const FDialoguePreparedConversation, ESPMode::ThreadSafe> UDialogueTrigger::GetPreparedConversation()
+{
+	// The task is usually finished when the player interacts. A task that is still queued behind other work is
+	// cancelled, because waiting for it on the game thread can take longer than preparing the text here
+	if (PreparationTask.IsValid())
+	{
+		if (PreparationTask.IsReady())
+		{
+			PreparedConversation = PreparationTask.Get();
+		}
+		else
+		{
+			ULog::Trace("DialogueTrigger::GetPreparedConversation", "The preparation task is not finished");
+			PreparationCancelled->store(true);
+			PreparedConversation.Reset();
+		}
+
+		PreparationTask = TFuture<TSharedPtr<const FDialoguePreparedConversation, ESPMode::ThreadSafe>>();
+		PreparationCancelled.Reset();
+	}
+
+	if (!PreparedConversation.IsValid() || !IsPreparationCurrent())
+	{
+		ULog::Trace("DialogueTrigger::GetPreparedConversation", "Preparing the conversation on the game thread");
+		PreparedSource = MakePreparationSource();
+		PreparedConversation = FDialoguePreparedConversation::Prepare(FDialoguePreparationSource(PreparedSource));
+	}
+
+	return PreparedConversation.ToSharedRef();
+}
+
+/**
+ * @brief Check if the dialogue properties still match the data the conversation was prepared from. Only compares
+ * the identity of the texts, so no text is formatted or converted
+ * @return A boolean value indicating if the prepared conversation is up to date
+ */
+bool UDialogueTrigger::IsPreparationCurrent() const
+{
+	auto TextsMatch = [](const TArray<FText>& A, const TArray<FText>& B)
+	{
+		if (A.Num() != B.Num())
+		{
+			return false;
+		}
+
+		for (int Index = 0; Index < A.Num(); Index++)
+		{
+			if (!A[Index].IdenticalTo(B[Index]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	if (!TextsMatch(DialogueTitles, PreparedSource.Titles) || !TextsMatch(DialogueMessages, PreparedSource.Messages)
+		|| DialogueChoices.Num() != PreparedSource.Choices.Num() || DialogueCues.Num() != PreparedSource.Cues.Num()
+		|| DialogueArguments.Num() != PreparedSource.Arguments.Num())
+	{
+		return false;
+	}
+
+	for (int Line = 0; Line < DialogueChoices.Num(); Line++)
+	{
+		const TArray<FDialogueChoice>& Choices = DialogueChoices[Line].Choices;
+		const TArray<FDialogueChoice>& PreparedChoices = PreparedSource.Choices[Line].Choices;
+		if (Choices.Num() != PreparedChoices.Num())
+		{
+			return false;
+		}
+
+		for (int ChoiceIndex = 0; ChoiceIndex < Choices.Num(); ChoiceIndex++)
+		{
+			const FDialogueChoice& Choice = Choices[ChoiceIndex];
+			const FDialogueChoice& PreparedChoice = PreparedChoices[ChoiceIndex];
+			if (!Choice.Text.IdenticalTo(PreparedChoice.Text) || Choice.NextLine != PreparedChoice.NextLine
+				|| Choice.VariableName != PreparedChoice.VariableName
+				|| Choice.VariableValue != PreparedChoice.VariableValue)
+			{
+				return false;
+			}
+		}
+	}
+
+	for (int Line = 0; Line < DialogueCues.Num(); Line++)
+	{
+		const TArray<FDialogueCue>& Cues = DialogueCues[Line].Cues;
+		const TArray<FDialogueCue>& PreparedCues = PreparedSource.Cues[Line].Cues;
+		if (Cues.Num() != PreparedCues.Num())
+		{
+			return false;
+		}
+
+		for (int Cue = 0; Cue < Cues.Num(); Cue++)
+		{
+			if (Cues[Cue].Offset != PreparedCues[Cue].Offset || Cues[Cue].Unit != PreparedCues[Cue].Unit
+				|| Cues[Cue].Event != PreparedCues[Cue].Event)
+			{
+				return false;
+			}
+		}
+	}
+
+	for (const TPair<FString, FText>& Argument : DialogueArguments)
+	{
+		const FFormatArgumentValue* PreparedArgument = PreparedSource.Arguments.Find(Argument.Key);
+		if (PreparedArgument == nullptr || PreparedArgument->GetType() != EFormatArgumentType::Text
+			|| !PreparedArgument->GetTextValue().IdenticalTo(Argument.Value))
+		{
+			return false;
+		}
+	}
+
+	return true;
 }
 
 /**
@@ -175,4 +509,143 @@ UDialogueWidget* UDialogueTrigger::GetDialogueWidget() const
 
 	ULog::Warning("DialogueTrigger::GetDialogueWidget", "Dynamic cast failed");
 	return nullptr;
-}
\ No newline at end of file
+}
+
+#if WITH_EDITOR
+/**
+ * @brief Validate the dialogue data. Used by the editor data validation and the dialogue validation commandlet
+ * @param ValidationErrors The errors found while validating the data
+ * @return The result of the validation
+ */
+EDataValidationResult UDialogueTrigger::IsDataValid(TArray<FText>& ValidationErrors)
+{
+	const EDataValidationResult Result = Super::IsDataValid(ValidationErrors);
+	const int NumErrors = ValidationErrors.Num();
+
+	if (PlayerClass == nullptr)
+	{
+		ValidationErrors.Add(FText::FromString("PlayerClass is not set so the conversation can never start"));
+	}
+
+	if (InputIndicatorWidgetClass == nullptr)
+	{
+		ValidationErrors.Add(FText::FromString("InputIndicatorWidgetClass is not set"));
+	}
+
+	const int NumLines = DialogueTitles.Num();
+	if (NumLines == 0 && DialogueMessages.Num() == 0 && DialogueVoices.Num() == 0)
+	{
+		ValidationErrors.Add(FText::FromString("The conversation has no lines"));
+	}
+	else if (NumLines != DialogueMessages.Num() || NumLines != DialogueVoices.Num())
+	{
+		ValidationErrors.Add(FText::FromString(FString::Printf(
+			TEXT("The conversation has %d titles, %d messages and %d voice lists. None of the lines can be shown"),
+			NumLines, DialogueMessages.Num(), DialogueVoices.Num())));
+	}
+
+	for (int Line = 0; Line < DialogueVoices.Num(); Line++)
+	{
+		const UDialogueVoiceList* VoiceList = DialogueVoices[Line] != nullptr
+			? DialogueVoices[Line].GetDefaultObject()
+			: nullptr;
+		if (VoiceList == nullptr)
+		{
+			ValidationErrors.Add(FText::FromString(FString::Printf(TEXT("Line %d has no voice list"), Line)));
+		}
+		else if (VoiceList->Voices.Num() == 0 && VoiceList->VoiceMode != EDialogueVoiceMode::Blips)
+		{
+			ValidationErrors.Add(FText::FromString(FString::Printf(TEXT("Line %d uses the empty voice list %s"),
+				Line, *DialogueVoices[Line]->GetName())));
+		}
+	}
+
+	if (DialogueChoices.Num() > NumLines)
+	{
+		ValidationErrors.Add(FText::FromString(FString::Printf(
+			TEXT("The conversation has choices for %d lines but only %d lines"), DialogueChoices.Num(), NumLines)));
+	}
+
+	for (int Line = 0; Line < DialogueChoices.Num(); Line++)
+	{
+		for (const FDialogueChoice& Choice : DialogueChoices[Line].Choices)
+		{
+			if (Choice.NextLine != INDEX_NONE && !DialogueTitles.IsValidIndex(Choice.NextLine))
+			{
+				ValidationErrors.Add(FText::FromString(FString::Printf(
+					TEXT("A choice of line %d continues to the missing line %d"), Line, Choice.NextLine)));
+			}
+		}
+	}
+
+	// Lines with choices only continue to the lines of their choices, so a line can be skipped by every path
+	TArray<bool> Reachable;
+	Reachable.Init(false, NumLines);
+	TArray<int> PendingLines;
+	if (NumLines > 0)
+	{
+		Reachable[0] = true;
+		PendingLines.Add(0);
+	}
+
+	while (PendingLines.Num() > 0)
+	{
+		const int Line = PendingLines.Pop(false);
+		const bool HasChoices = DialogueChoices.IsValidIndex(Line) && DialogueChoices[Line].Choices.Num() > 0;
+		if (!HasChoices)
+		{
+			if (Reachable.IsValidIndex(Line + 1) && !Reachable[Line + 1])
+			{
+				Reachable[Line + 1] = true;
+				PendingLines.Add(Line + 1);
+			}
+
+			continue;
+		}
+
+		for (const FDialogueChoice& Choice : DialogueChoices[Line].Choices)
+		{
+			if (Reachable.IsValidIndex(Choice.NextLine) && !Reachable[Choice.NextLine])
+			{
+				Reachable[Choice.NextLine] = true;
+				PendingLines.Add(Choice.NextLine);
+			}
+		}
+	}
+
+	for (int Line = 0; Line < NumLines; Line++)
+	{
+		if (!Reachable[Line])
+		{
+			ValidationErrors.Add(FText::FromString(FString::Printf(
+				TEXT("Line %d can never be shown because no line or choice continues to it"), Line)));
+		}
+	}
+
+	if (DialogueCues.Num() > NumLines)
+	{
+		ValidationErrors.Add(FText::FromString(FString::Printf(
+			TEXT("The conversation has cues for %d lines but only %d lines"), DialogueCues.Num(), NumLines)));
+	}
+
+	for (int Line = 0; Line < DialogueCues.Num() && Line < DialogueMessages.Num(); Line++)
+	{
+		const int MessageLength = DialogueMessages[Line].ToString().Len();
+		for (const FDialogueCue& Cue : DialogueCues[Line].Cues)
+		{
+			if (Cue.Offset < 0 || Cue.Offset > (Cue.Unit == EDialogueCueUnit::PerMille ? 1000 : MessageLength))
+			{
+				ValidationErrors.Add(FText::FromString(FString::Printf(
+					TEXT("The cue %s of line %d is outside of the message"), *Cue.Event.ToString(), Line)));
+			}
+		}
+	}
+
+	if (ValidationErrors.Num() > NumErrors)
+	{
+		return EDataValidationResult::Invalid;
+	}
+
+	return Result == EDataValidationResult::NotValidated ? EDataValidationResult::Valid : Result;
+}
+#endif
\ No newline at end of file
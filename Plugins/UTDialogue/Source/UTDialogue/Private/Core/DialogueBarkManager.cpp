@@ -0,0 +1,546 @@
+﻿#include "Core/DialogueBarkManager.h"
+#include "Components/AudioComponent.h"
+#include "Core/DialogueStats.h"
+#include "Core/Log.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bark Scheduler Tick"), STAT_DialogueBarkTick, STATGROUP_UTDialogue);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bark Speakers"), STAT_DialogueBarkSpeakers, STATGROUP_UTDialogue);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Bark Evaluations"), STAT_DialogueBarkEvaluations, STATGROUP_UTDialogue);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Barks"), STAT_DialogueActiveBarks, STATGROUP_UTDialogue);
+
+static FAutoConsoleCommandWithWorldAndArgs BarkBenchmarkCommand(
+	TEXT("UTDialogue.Barks.Benchmark"),
+	TEXT("Run the bark scheduler against synthetic speakers. Usage: UTDialogue.Barks.Benchmark [Speakers] [Frames]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const int NumFrames = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1000;
+		if (Args.Num() > 0)
+		{
+			ADialogueBarkManager::RunSchedulerBenchmark(World, FCString::Atoi(*Args[0]), NumFrames);
+			return;
+		}
+
+		for (const int NumSpeakers : {100, 1000, 10000})
+		{
+			ADialogueBarkManager::RunSchedulerBenchmark(World, NumSpeakers, NumFrames);
+		}
+	}));
+
+ADialogueBarkManager::ADialogueBarkManager()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+
+	SubtitleSpace = EWidgetSpace::World;
+	SubtitleOffset = FVector(0.0f, 0.0f, 120.0f);
+	VoiceAttenuation = nullptr;
+	MaxConcurrentBarks = 4;
+	MaxEvaluationsPerFrame = 32;
+	RetryDelay = 1.0f;
+	RequestPriorityBonus = 1.0f;
+	FullDetailDistance = 1500.0f;
+	MaxBarkDistance = 3000.0f;
+	ReducedDetailLod = EDialogueBarkLod::TextOnly;
+	CullOffscreenSpeakers = true;
+	OffscreenTolerance = 0.2f;
+	EvaluationCursor = 0;
+}
+
+/**
+ * @brief Called when the game starts or when spawned
+ */
+void ADialogueBarkManager::BeginPlay()
+{
+	Super::BeginPlay();
+	CreateSlots();
+}
+
+/**
+ * @brief Function called every frame on this actor
+ * @param DeltaSeconds The time since the last tick
+ */
+void ADialogueBarkManager::Tick(const float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_DialogueBarkTick);
+	Super::Tick(DeltaSeconds);
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	UpdateActiveBarks(Now);
+
+	const APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(this, 0);
+	if (CameraManager == nullptr || Speakers.Num() == 0)
+	{
+		return;
+	}
+
+	EvaluateSpeakers(CameraManager->GetCameraLocation(), Now);
+	StartBarks(Now);
+
+	SET_DWORD_STAT(STAT_DialogueBarkSpeakers, Speakers.Num());
+	SET_DWORD_STAT(STAT_DialogueActiveBarks, GetActiveBarkCount());
+}
+
+/**
+ * @brief Register a speaker with the bark manager
+ * @param Speaker The bark component of the speaker
+ */
+void ADialogueBarkManager::RegisterSpeaker(UDialogueBarkComponent* Speaker)
+{
+	if (Speaker == nullptr || Speaker->SpeakerIndex != INDEX_NONE)
+	{
+		ULog::Warning("DialogueBarkManager::RegisterSpeaker", "Speaker is invalid or already registered");
+		return;
+	}
+
+	FDialogueBarkSpeaker NewSpeaker;
+	NewSpeaker.Component = Speaker;
+	NewSpeaker.NextBarkTime = GetWorld()->GetTimeSeconds() + Speaker->GetRandomBarkInterval();
+	Speaker->SpeakerIndex = Speakers.Add(NewSpeaker);
+}
+
+/**
+ * @brief Unregister a speaker from the bark manager and stop its active bark
+ * @param Speaker The bark component of the speaker
+ */
+void ADialogueBarkManager::UnregisterSpeaker(UDialogueBarkComponent* Speaker)
+{
+	if (Speaker == nullptr || !Speakers.IsValidIndex(Speaker->SpeakerIndex))
+	{
+		return;
+	}
+
+	const int RemovedIndex = Speaker->SpeakerIndex;
+	if (Speakers[RemovedIndex].ActiveSlot != INDEX_NONE)
+	{
+		StopBark(Speakers[RemovedIndex].ActiveSlot);
+	}
+
+	Speakers.RemoveAtSwap(RemovedIndex, 1, false);
+	Speaker->SpeakerIndex = INDEX_NONE;
+
+	if (!Speakers.IsValidIndex(RemovedIndex))
+	{
+		return;
+	}
+
+	FDialogueBarkSpeaker& MovedSpeaker = Speakers[RemovedIndex];
+	if (UDialogueBarkComponent* MovedComponent = MovedSpeaker.Component.Get())
+	{
+		MovedComponent->SpeakerIndex = RemovedIndex;
+	}
+
+	if (MovedSpeaker.ActiveSlot != INDEX_NONE)
+	{
+		Slots[MovedSpeaker.ActiveSlot].SpeakerIndex = RemovedIndex;
+	}
+}
+
+/**
+ * @brief Request a bark for the specified speaker
+ * @param Speaker The bark component of the speaker
+ * @param LineIndex The index of the line to play or -1 to play a random line
+ */
+void ADialogueBarkManager::RequestBark(const UDialogueBarkComponent* Speaker, const int LineIndex)
+{
+	if (Speaker == nullptr || !Speakers.IsValidIndex(Speaker->SpeakerIndex))
+	{
+		ULog::Warning("DialogueBarkManager::RequestBark", "Speaker is not registered");
+		return;
+	}
+
+	FDialogueBarkSpeaker& RequestingSpeaker = Speakers[Speaker->SpeakerIndex];
+	RequestingSpeaker.HasRequest = true;
+	RequestingSpeaker.RequestedLine = LineIndex;
+	RequestingSpeaker.NextBarkTime = 0.0f;
+}
+
+/**
+ * @brief Get the number of barks that are currently playing
+ * @return The number of barks that are currently playing
+ */
+int ADialogueBarkManager::GetActiveBarkCount() const
+{
+	int ActiveBarks = 0;
+	for (const FDialogueBarkSlot& Slot : Slots)
+	{
+		ActiveBarks += Slot.SpeakerIndex != INDEX_NONE ? 1 : 0;
+	}
+
+	return ActiveBarks;
+}
+
+/**
+ * @brief Evaluate a speaker and calculate the priority and level of detail of its bark
+ * @param DistanceSquared The squared distance between the listener and the speaker
+ * @param Importance The importance of the speaker
+ * @param HasRequest Boolean value indicating if the bark was explicitly requested
+ * @param OutCandidate The candidate that is updated with the priority and level of detail
+ * @return A boolean value indicating if the speaker should be considered for a bark
+ */
+bool ADialogueBarkManager::EvaluateCandidate(const float DistanceSquared, const float Importance,
+	const bool HasRequest, FDialogueBarkCandidate& OutCandidate) const
+{
+	if (DistanceSquared > FMath::Square(MaxBarkDistance))
+	{
+		OutCandidate.Lod = EDialogueBarkLod::Culled;
+		return false;
+	}
+
+	OutCandidate.Lod = DistanceSquared > FMath::Square(FullDetailDistance) ? ReducedDetailLod : EDialogueBarkLod::Full;
+	if (OutCandidate.Lod == EDialogueBarkLod::Culled)
+	{
+		return false;
+	}
+
+	const float DistanceFactor = 1.0f - FMath::Sqrt(DistanceSquared) / FMath::Max(MaxBarkDistance, 1.0f);
+	OutCandidate.Priority = Importance * DistanceFactor + (HasRequest ? RequestPriorityBonus : 0.0f);
+	return true;
+}
+
+/**
+ * @brief Sort the candidates so that the candidates with the highest priority are at the start of the array
+ * @param Candidates The candidates evaluated during the current frame
+ * @param FreeSlots The number of barks that can still be started
+ */
+void ADialogueBarkManager::SelectCandidates(TArray<FDialogueBarkCandidate>& Candidates, const int FreeSlots)
+{
+	const int NumSelected = FMath::Min(FreeSlots, Candidates.Num());
+	for (int Selected = 0; Selected < NumSelected; Selected++)
+	{
+		int BestIndex = Selected;
+		for (int Index = Selected + 1; Index < Candidates.Num(); Index++)
+		{
+			if (Candidates[Index].Priority > Candidates[BestIndex].Priority)
+			{
+				BestIndex = Index;
+			}
+		}
+
+		Candidates.Swap(Selected, BestIndex);
+	}
+}
+
+/**
+ * @brief Run the scheduler of a temporary bark manager against synthetic speakers and log the cost per frame.
+ * The speakers and the manager are destroyed after the benchmark
+ * @param World The world used to spawn the manager and the speakers
+ * @param NumSpeakers The number of synthetic speakers
+ * @param NumFrames The number of frames to simulate
+ */
+void ADialogueBarkManager::RunSchedulerBenchmark(UWorld* World, const int NumSpeakers, const int NumFrames)
+{
+	if (World == nullptr || !World->HasBegunPlay() || NumSpeakers <= 0 || NumFrames <= 0)
+	{
+		ULog::Error("DialogueBarkManager::RunSchedulerBenchmark", "Invalid benchmark arguments or world not playing");
+		return;
+	}
+
+	// The benchmark manager uses the settings of the manager placed in the map, but never culls offscreen speakers
+	// because the synthetic speakers are never rendered
+	const ADialogueBarkManager* Settings = dynamic_cast<ADialogueBarkManager*>(
+		UGameplayStatics::GetActorOfClass(World, StaticClass()));
+	ADialogueBarkManager* Manager = World->SpawnActorDeferred<ADialogueBarkManager>(StaticClass(), FTransform::Identity);
+	if (Settings != nullptr)
+	{
+		Manager->BarkWidgetClass = Settings->BarkWidgetClass;
+		Manager->SubtitleSpace = Settings->SubtitleSpace;
+		Manager->MaxConcurrentBarks = Settings->MaxConcurrentBarks;
+		Manager->MaxEvaluationsPerFrame = Settings->MaxEvaluationsPerFrame;
+		Manager->RetryDelay = Settings->RetryDelay;
+		Manager->FullDetailDistance = Settings->FullDetailDistance;
+		Manager->MaxBarkDistance = Settings->MaxBarkDistance;
+		Manager->ReducedDetailLod = Settings->ReducedDetailLod;
+	}
+
+	Manager->CullOffscreenSpeakers = false;
+	Manager->SetActorTickEnabled(false);
+	Manager->FinishSpawning(FTransform::Identity);
+
+	// The speakers are registered directly so they never join the manager placed in the map
+	FRandomStream Random(NumSpeakers);
+	TArray<AActor*> SpeakerActors;
+	SpeakerActors.Reserve(NumSpeakers);
+	Manager->Speakers.Reserve(NumSpeakers);
+	for (int Index = 0; Index < NumSpeakers; Index++)
+	{
+		AActor* SpeakerActor = World->SpawnActor<AActor>();
+		USceneComponent* SpeakerRoot = NewObject<USceneComponent>(SpeakerActor);
+		SpeakerActor->SetRootComponent(SpeakerRoot);
+		SpeakerRoot->RegisterComponent();
+		SpeakerActor->SetActorLocation(
+			FVector(Random.FRandRange(-5000.0f, 5000.0f), Random.FRandRange(-5000.0f, 5000.0f), 0.0f));
+
+		UDialogueBarkComponent* Component = NewObject<UDialogueBarkComponent>(SpeakerActor);
+		Component->BarkLines.Add(FText::FromString("Benchmark"));
+		Component->Importance = Random.FRandRange(0.5f, 2.0f);
+		Component->MinBarkInterval = 0.0f;
+		Component->MaxBarkInterval = 10.0f;
+		Component->BarkRandom.Initialize(Index);
+		Manager->RegisterSpeaker(Component);
+		SpeakerActors.Add(SpeakerActor);
+	}
+
+	const float StartTime = World->GetTimeSeconds();
+	uint64 TotalCycles = 0;
+	uint64 MaxCycles = 0;
+	for (int Frame = 0; Frame < NumFrames; Frame++)
+	{
+		const float Now = StartTime + Frame / 60.0f;
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+
+		Manager->UpdateActiveBarks(Now);
+		Manager->EvaluateSpeakers(FVector::ZeroVector, Now);
+		Manager->StartBarks(Now);
+
+		const uint64 FrameCycles = FPlatformTime::Cycles64() - StartCycles;
+		TotalCycles += FrameCycles;
+		MaxCycles = FMath::Max(MaxCycles, FrameCycles);
+	}
+
+	for (AActor* SpeakerActor : SpeakerActors)
+	{
+		SpeakerActor->Destroy();
+	}
+
+	Manager->Destroy();
+
+	const double AverageMicroseconds = FPlatformTime::ToMilliseconds64(TotalCycles) * 1000.0 / NumFrames;
+	const double MaxMicroseconds = FPlatformTime::ToMilliseconds64(MaxCycles) * 1000.0;
+	ULog::Info("DialogueBarkManager::RunSchedulerBenchmark", FString::Printf(
+		TEXT("Speakers = %d, Frames = %d, Average = %.3f us, Max = %.3f us"),
+		NumSpeakers, NumFrames, AverageMicroseconds, MaxMicroseconds));
+}
+
+/**
+ * @brief Create the subtitle and voice components used by the slots
+ */
+void ADialogueBarkManager::CreateSlots()
+{
+	if (BarkWidgetClass == nullptr)
+	{
+		ULog::Error("DialogueBarkManager::CreateSlots", "Bark widget class not set");
+	}
+
+	Slots.SetNum(MaxConcurrentBarks);
+	Candidates.Reserve(MaxEvaluationsPerFrame);
+
+	for (int SlotIndex = 0; SlotIndex < MaxConcurrentBarks; SlotIndex++)
+	{
+		UWidgetComponent* Subtitle = NewObject<UWidgetComponent>(this);
+		Subtitle->SetWidgetSpace(SubtitleSpace);
+		Subtitle->SetWidgetClass(BarkWidgetClass);
+		Subtitle->SetDrawAtDesiredSize(true);
+		Subtitle->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Subtitle->SetVisibility(false);
+		Subtitle->RegisterComponent();
+		Subtitle->InitWidget();
+		SubtitleComponents.Add(Subtitle);
+
+		UAudioComponent* Voice = NewObject<UAudioComponent>(this);
+		Voice->bAutoActivate = false;
+		Voice->bAllowSpatialization = true;
+		Voice->AttenuationSettings = VoiceAttenuation;
+		Voice->RegisterComponent();
+		VoiceComponents.Add(Voice);
+	}
+}
+
+/**
+ * @brief Stop the barks that are finished or whose speaker is no longer valid
+ * @param Now The current world time
+ */
+void ADialogueBarkManager::UpdateActiveBarks(const float Now)
+{
+	for (int SlotIndex = 0; SlotIndex < Slots.Num(); SlotIndex++)
+	{
+		const FDialogueBarkSlot& Slot = Slots[SlotIndex];
+		if (Slot.SpeakerIndex == INDEX_NONE)
+		{
+			continue;
+		}
+
+		if (Now >= Slot.EndTime || !Speakers[Slot.SpeakerIndex].Component.IsValid())
+		{
+			StopBark(SlotIndex);
+		}
+	}
+}
+
+/**
+ * @brief Evaluate the next batch of speakers and add the valid speakers to the candidates
+ * @param ListenerLocation The location of the listener
+ * @param Now The current world time
+ */
+void ADialogueBarkManager::EvaluateSpeakers(const FVector& ListenerLocation, const float Now)
+{
+	Candidates.Reset();
+
+	const int NumEvaluations = FMath::Min(MaxEvaluationsPerFrame, Speakers.Num());
+	INC_DWORD_STAT_BY(STAT_DialogueBarkEvaluations, NumEvaluations);
+
+	for (int Evaluation = 0; Evaluation < NumEvaluations; Evaluation++)
+	{
+		EvaluationCursor = EvaluationCursor % Speakers.Num();
+		const int SpeakerIndex = EvaluationCursor++;
+		FDialogueBarkSpeaker& Speaker = Speakers[SpeakerIndex];
+
+		const UDialogueBarkComponent* Component = Speaker.Component.Get();
+		if (Component == nullptr || Speaker.ActiveSlot != INDEX_NONE || Now < Speaker.NextBarkTime)
+		{
+			continue;
+		}
+
+		if (!Speaker.HasRequest && !Component->AutoBark)
+		{
+			Speaker.NextBarkTime = Now + Component->GetRandomBarkInterval();
+			continue;
+		}
+
+		const AActor* Owner = Component->GetOwner();
+		if (Owner == nullptr || Component->BarkLines.Num() == 0)
+		{
+			Speaker.HasRequest = false;
+			Speaker.NextBarkTime = Now + Component->GetRandomBarkInterval();
+			continue;
+		}
+
+		FDialogueBarkCandidate Candidate;
+		Candidate.SpeakerIndex = SpeakerIndex;
+		const float DistanceSquared = FVector::DistSquared(ListenerLocation, Owner->GetActorLocation());
+		if (!EvaluateCandidate(DistanceSquared, Component->Importance, Speaker.HasRequest, Candidate))
+		{
+			Speaker.HasRequest = false;
+			Speaker.NextBarkTime = Now + Component->GetRandomBarkInterval();
+			continue;
+		}
+
+		if (CullOffscreenSpeakers && !Owner->WasRecentlyRendered(OffscreenTolerance))
+		{
+			Speaker.NextBarkTime = Now + RetryDelay;
+			continue;
+		}
+
+		Candidates.Add(Candidate);
+	}
+}
+
+/**
+ * @brief Start the barks of the candidates with the highest priority
+ * @param Now The current world time
+ */
+void ADialogueBarkManager::StartBarks(const float Now)
+{
+	const int FreeSlots = Slots.Num() - GetActiveBarkCount();
+	SelectCandidates(Candidates, FreeSlots);
+
+	for (int Index = 0; Index < Candidates.Num(); Index++)
+	{
+		const FDialogueBarkCandidate& Candidate = Candidates[Index];
+		const int SlotIndex = Index < FreeSlots ? GetFreeSlot() : INDEX_NONE;
+		if (SlotIndex == INDEX_NONE)
+		{
+			Speakers[Candidate.SpeakerIndex].NextBarkTime = Now + RetryDelay;
+			continue;
+		}
+
+		StartBark(SlotIndex, Candidate, Now);
+	}
+}
+
+/**
+ * @brief Start a bark in the specified slot
+ * @param SlotIndex The index of the slot
+ * @param Candidate The candidate that will use the slot
+ * @param Now The current world time
+ */
+void ADialogueBarkManager::StartBark(const int SlotIndex, const FDialogueBarkCandidate& Candidate, const float Now)
+{
+	FDialogueBarkSpeaker& Speaker = Speakers[Candidate.SpeakerIndex];
+	UDialogueBarkComponent* Component = Speaker.Component.Get();
+	USceneComponent* SpeakerRoot = Component->GetOwner()->GetRootComponent();
+
+	const int LineIndex = Component->BarkLines.IsValidIndex(Speaker.RequestedLine)
+		? Speaker.RequestedLine
+		: Component->GetRandomBarkLine();
+
+	UWidgetComponent* Subtitle = SubtitleComponents[SlotIndex];
+	UDialogueBarkWidget* BarkWidget = dynamic_cast<UDialogueBarkWidget*>(Subtitle->GetUserWidgetObject());
+	if (Candidate.Lod != EDialogueBarkLod::VoiceOnly && BarkWidget != nullptr && SpeakerRoot != nullptr)
+	{
+		Subtitle->AttachToComponent(SpeakerRoot, FAttachmentTransformRules::KeepRelativeTransform);
+		Subtitle->SetRelativeLocation(SubtitleOffset);
+		Subtitle->SetVisibility(true);
+		BarkWidget->ShowBark(Component->BarkLines[LineIndex]);
+	}
+
+	UAudioComponent* Voice = VoiceComponents[SlotIndex];
+	const UDialogueVoiceList* VoiceList = Component->BarkVoices != nullptr
+		? Component->BarkVoices.GetDefaultObject()
+		: nullptr;
+	const int VoiceIndex = Candidate.Lod != EDialogueBarkLod::TextOnly && SpeakerRoot != nullptr
+		? Component->VoiceSelector.SelectVoice(VoiceList)
+		: INDEX_NONE;
+	if (VoiceIndex != INDEX_NONE)
+	{
+		Voice->AttachToComponent(SpeakerRoot, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+		Voice->SetSound(VoiceList->Voices[VoiceIndex]);
+		Voice->Play();
+	}
+
+	FDialogueBarkSlot& Slot = Slots[SlotIndex];
+	Slot.SpeakerIndex = Candidate.SpeakerIndex;
+	Slot.EndTime = Now + Component->GetDisplayTime(LineIndex);
+
+	Speaker.ActiveSlot = SlotIndex;
+	Speaker.HasRequest = false;
+	Speaker.RequestedLine = INDEX_NONE;
+	Speaker.NextBarkTime = Slot.EndTime + Component->GetRandomBarkInterval();
+}
+
+/**
+ * @brief Stop the bark in the specified slot
+ * @param SlotIndex The index of the slot
+ */
+void ADialogueBarkManager::StopBark(const int SlotIndex)
+{
+	FDialogueBarkSlot& Slot = Slots[SlotIndex];
+	if (Speakers.IsValidIndex(Slot.SpeakerIndex))
+	{
+		Speakers[Slot.SpeakerIndex].ActiveSlot = INDEX_NONE;
+	}
+
+	UWidgetComponent* Subtitle = SubtitleComponents[SlotIndex];
+	if (UDialogueBarkWidget* BarkWidget = dynamic_cast<UDialogueBarkWidget*>(Subtitle->GetUserWidgetObject()))
+	{
+		BarkWidget->HideBark();
+	}
+
+	Subtitle->SetVisibility(false);
+	Subtitle->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
+
+	UAudioComponent* Voice = VoiceComponents[SlotIndex];
+	Voice->Stop();
+	Voice->AttachToComponent(RootComponent, FAttachmentTransformRules::SnapToTargetNotIncludingScale);
+
+	Slot.SpeakerIndex = INDEX_NONE;
+}
+
+/**
+ * @brief Get the index of a slot that is not playing a bark
+ * @return The index of a free slot or -1 if all the slots are used
+ */
+int ADialogueBarkManager::GetFreeSlot() const
+{
+	for (int SlotIndex = 0; SlotIndex < Slots.Num(); SlotIndex++)
+	{
+		if (Slots[SlotIndex].SpeakerIndex == INDEX_NONE)
+		{
+			return SlotIndex;
+		}
+	}
+
+	return INDEX_NONE;
+}
\ No newline at end of file
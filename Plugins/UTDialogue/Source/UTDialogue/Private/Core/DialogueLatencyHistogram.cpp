@@ -0,0 +1,97 @@
+﻿#include "Core/DialogueLatencyHistogram.h"
+
+/**
+ * @brief Add a latency to the histogram
+ * @param Milliseconds The latency in milliseconds
+ */
+void FDialogueLatencyHistogram::Add(const float Milliseconds)
+{
+	Buckets[GetBucket(Milliseconds)]++;
+	Count++;
+	Max = FMath::Max(Max, Milliseconds);
+}
+
+/**
+ * @brief Remove all the latencies from the histogram
+ */
+void FDialogueLatencyHistogram::Reset()
+{
+	FMemory::Memzero(Buckets);
+	Count = 0;
+	Max = 0.0f;
+}
+
+/**
+ * @brief Get the latency below which the specified percentage of the latencies fall
+ * @param Percentile The percentage between 0 and 100
+ * @return The upper bound of the bucket containing the percentile in milliseconds or 0 if the histogram is empty
+ */
+float FDialogueLatencyHistogram::GetPercentile(const float Percentile) const
+{
+	if (Count == 0)
+	{
+		return 0.0f;
+	}
+
+	const uint32 Target = FMath::Max(1u, static_cast<uint32>(FMath::CeilToInt(
+		FMath::Clamp(Percentile, 0.0f, 100.0f) / 100.0f * Count)));
+	uint32 Cumulative = 0;
+	for (int Bucket = 0; Bucket < NumBuckets; Bucket++)
+	{
+		Cumulative += Buckets[Bucket];
+		if (Cumulative >= Target)
+		{
+			return FMath::Min(GetBucketBound(Bucket), Max);
+		}
+	}
+
+	return Max;
+}
+
+/**
+ * @brief Get the fraction of the latencies that are higher than the specified budget
+ * @param Milliseconds The latency budget in milliseconds
+ * @return The fraction of the latencies over the budget between 0 and 1
+ */
+float FDialogueLatencyHistogram::GetFractionAbove(const float Milliseconds) const
+{
+	if (Count == 0)
+	{
+		return 0.0f;
+	}
+
+	// Buckets that straddle the budget are counted as over the budget
+	uint32 Above = 0;
+	for (int Bucket = GetBucket(Milliseconds); Bucket < NumBuckets; Bucket++)
+	{
+		Above += Buckets[Bucket];
+	}
+
+	return static_cast<float>(Above) / Count;
+}
+
+/**
+ * @brief Get the bucket of the specified latency
+ * @param Milliseconds The latency in milliseconds
+ * @return The index of the bucket
+ */
+int FDialogueLatencyHistogram::GetBucket(const float Milliseconds)
+{
+	if (Milliseconds <= FirstBucketBound)
+	{
+		return 0;
+	}
+
+	const int Bucket = FMath::CeilToInt(4.0f * FMath::Log2(Milliseconds / FirstBucketBound));
+	return FMath::Clamp(Bucket, 0, NumBuckets - 1);
+}
+
+/**
+ * @brief Get the upper bound of the specified bucket
+ * @param Bucket The index of the bucket
+ * @return The upper bound of the bucket in milliseconds
+ */
+float FDialogueLatencyHistogram::GetBucketBound(const int Bucket)
+{
+	return FirstBucketBound * FMath::Pow(2.0f, Bucket / 4.0f);
+}
\ No newline at end of file
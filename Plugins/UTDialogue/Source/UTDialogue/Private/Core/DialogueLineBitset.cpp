@@ -0,0 +1,86 @@
+﻿#include "Core/DialogueLineBitset.h"
+
+/**
+ * @brief Change the number of bits in the bitset. New bits are cleared
+ * @param NewNum The number of bits
+ */
+void FDialogueLineBitset::SetNum(const int NewNum)
+{
+	NumBits = FMath::Max(NewNum, 0);
+	const int NewNumWords = (NumBits + 31) >> 5;
+	Words.SetNumZeroed(NewNumWords);
+	DirtyMask.SetNumZeroed((NewNumWords + 31) >> 5);
+	DirtyWords.RemoveAll([NewNumWords](const int WordIndex) { return WordIndex >= NewNumWords; });
+}
+
+/**
+ * @brief Set the specified bit and mark the word as changed
+ * @param Bit The index of the bit
+ */
+void FDialogueLineBitset::Set(const int Bit)
+{
+	if (Bit < 0 || Bit >= NumBits)
+	{
+		return;
+	}
+
+	const int WordIndex = Bit >> 5;
+	const uint32 Mask = 1u << (Bit & 31);
+	if ((Words[WordIndex] & Mask) != 0)
+	{
+		return;
+	}
+
+	Words[WordIndex] |= Mask;
+
+	const uint32 DirtyBit = 1u << (WordIndex & 31);
+	if ((DirtyMask[WordIndex >> 5] & DirtyBit) == 0)
+	{
+		DirtyMask[WordIndex >> 5] |= DirtyBit;
+		DirtyWords.Add(WordIndex);
+	}
+}
+
+/**
+ * @brief Remove all the bits
+ */
+void FDialogueLineBitset::Empty()
+{
+	Words.Empty();
+	DirtyMask.Empty();
+	DirtyWords.Empty();
+	NumBits = 0;
+}
+
+/**
+ * @brief Replace a word in the bitset. The bitset grows if needed and the word is not marked as changed
+ * @param WordIndex The index of the word
+ * @param Word The new value of the word
+ */
+void FDialogueLineBitset::SetWord(const int WordIndex, const uint32 Word)
+{
+	if (WordIndex < 0)
+	{
+		return;
+	}
+
+	if (WordIndex >= Words.Num())
+	{
+		SetNum((WordIndex + 1) << 5);
+	}
+
+	Words[WordIndex] = Word;
+}
+
+/**
+ * @brief Forget the words that changed
+ */
+void FDialogueLineBitset::ClearDirtyWords()
+{
+	for (const int WordIndex : DirtyWords)
+	{
+		DirtyMask[WordIndex >> 5] &= ~(1u << (WordIndex & 31));
+	}
+
+	DirtyWords.Reset();
+}
\ No newline at end of file
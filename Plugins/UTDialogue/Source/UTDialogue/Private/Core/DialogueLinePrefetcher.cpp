@@ -0,0 +1,288 @@
+﻿#include "Core/DialogueLinePrefetcher.h"
+#include "Containers/Ticker.h"
+#include "Core/DialogueMockLineProvider.h"
+#include "Core/DialogueStats.h"
+#include "Core/Log.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Provided Line Requests"), STAT_DialogueLineRequests, STATGROUP_UTDialogue);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Provided Line Cache Hits"), STAT_DialogueLineCacheHits, STATGROUP_UTDialogue);
+
+static FAutoConsoleCommand LineProviderBenchmarkCommand(
+	TEXT("UTDialogue.LineProvider.Benchmark"),
+	TEXT("Measure how much provider latency is hidden by prefetching. ")
+	TEXT("Usage: UTDialogue.LineProvider.Benchmark [Lines] [LatencyMs] [TypingMs] [Prefetch]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int NumLines = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10;
+		const float Latency = (Args.Num() > 1 ? FCString::Atof(*Args[1]) : 200.0f) / 1000.0f;
+		const float TypingTime = (Args.Num() > 2 ? FCString::Atof(*Args[2]) : 150.0f) / 1000.0f;
+		FDialogueLinePrefetcher::RunPrefetchBenchmark(NumLines, Latency, TypingTime,
+			Args.Num() > 3 ? TArray<int>{FCString::Atoi(*Args[3])} : TArray<int>{0, 1, 3});
+	}));
+
+/**
+ * @brief The state of the prefetch benchmark between two ticks
+ */
+struct FDialoguePrefetchBenchmark
+{
+	/**
+	 * @brief The prefetcher of the simulated conversation
+	 */
+	FDialogueLinePrefetcher Prefetcher;
+
+	/**
+	 * @brief The mock provider. Kept in the root set while the benchmark runs
+	 */
+	UDialogueMockLineProvider* Provider = nullptr;
+
+	/**
+	 * @brief The request sent for every line
+	 */
+	FDialogueLineRequest Request;
+
+	/**
+	 * @brief The number of lines requested ahead of the current line in every simulated conversation
+	 */
+	TArray<int> PrefetchCounts;
+
+	/**
+	 * @brief The index of the current simulated conversation
+	 */
+	int Run = 0;
+
+	/**
+	 * @brief The number of lines in the simulated conversation
+	 */
+	int NumLines = 0;
+
+	/**
+	 * @brief The latency of the mock provider in seconds
+	 */
+	float Latency = 0.0f;
+
+	/**
+	 * @brief The time in seconds spent typing every line
+	 */
+	float TypingTime = 0.0f;
+
+	/**
+	 * @brief The current line of the simulated conversation
+	 */
+	int Line = 0;
+
+	/**
+	 * @brief The time when the current line started waiting for the provider or a negative value if it is typing
+	 */
+	double WaitStart = -1.0;
+
+	/**
+	 * @brief The time when the current line is fully typed
+	 */
+	double TypingEnd = 0.0;
+
+	/**
+	 * @brief The total time spent waiting for the provider in the current simulated conversation
+	 */
+	double TotalWait = 0.0;
+
+	/**
+	 * @brief The longest time spent waiting for a single line in the current simulated conversation
+	 */
+	double MaxWait = 0.0;
+
+	explicit FDialoguePrefetchBenchmark(const int InNumLines)
+		: Prefetcher(InNumLines)
+	{
+	}
+
+	/**
+	 * @brief Advance the simulated conversation without blocking
+	 * @return A boolean value indicating if the benchmark should be ticked again
+	 */
+	bool Tick()
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Line >= NumLines)
+		{
+			LogResult();
+			if (++Run >= PrefetchCounts.Num())
+			{
+				Provider->RemoveFromRoot();
+				return false;
+			}
+
+			Prefetcher.Reset();
+			Line = 0;
+			TotalWait = 0.0;
+			MaxWait = 0.0;
+		}
+
+		if (WaitStart < 0.0)
+		{
+			if (Now < TypingEnd)
+			{
+				return true;
+			}
+
+			const int LastLine = FMath::Min(Line + PrefetchCounts[Run], NumLines - 1);
+			for (int PrefetchLine = Line; PrefetchLine <= LastLine; PrefetchLine++)
+			{
+				Request.Line = PrefetchLine;
+				Prefetcher.Prefetch(Provider, Request);
+			}
+
+			WaitStart = Now;
+		}
+
+		// The wait is measured by polling once per frame, like the dialogue widget does
+		FText Message;
+		if (!Prefetcher.TryGetLine({Request.ConversationId, Line, Request.Context, Request.Culture}, Message))
+		{
+			return true;
+		}
+
+		const double Wait = Now - WaitStart;
+		TotalWait += Wait;
+		MaxWait = FMath::Max(MaxWait, Wait);
+		WaitStart = -1.0;
+		TypingEnd = Now + TypingTime;
+		Line++;
+		return true;
+	}
+
+	/**
+	 * @brief Log the result of the current simulated conversation
+	 */
+	void LogResult() const
+	{
+		const double UnhiddenWait = static_cast<double>(Latency) * NumLines;
+		const double HiddenPercentage = UnhiddenWait > 0.0 ? 100.0 * (1.0 - TotalWait / UnhiddenWait) : 100.0;
+		ULog::Info("DialogueLinePrefetcher::RunPrefetchBenchmark", FString::Printf(
+			TEXT("Lines = %d, Latency = %.0f ms, Typing = %.0f ms, Prefetch = %d: waited %.1f ms per line ")
+			TEXT("(max %.1f ms), %.0f%% of the latency hidden"), NumLines, Latency * 1000.0f, TypingTime * 1000.0f,
+			PrefetchCounts[Run], TotalWait * 1000.0 / NumLines, MaxWait * 1000.0, HiddenPercentage));
+	}
+};
+
+/**
+ * @brief Create a prefetcher
+ * @param CacheCapacity The maximum number of provided lines in the cache
+ */
+FDialogueLinePrefetcher::FDialogueLinePrefetcher(const int CacheCapacity)
+	: Cache(FMath::Max(CacheCapacity, 1))
+{
+}
+
+/**
+ * @brief Request a line unless it is already cached or requested. A provider that returns no future provides no
+ * line, so an empty message is cached and the static message is used
+ * @param Provider The provider of the line
+ * @param Request The line to request
+ */
+void FDialogueLinePrefetcher::Prefetch(UDialogueLineProvider* Provider, const FDialogueLineRequest& Request)
+{
+	const FDialogueLineKey Key{Request.ConversationId, Request.Line, Request.Context, Request.Culture};
+	if (Provider == nullptr || Cache.Contains(Key) || PendingRequests.Contains(Key))
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_DialogueLineRequests);
+	TFuture<FText> Future = Provider->RequestLine(Request);
+	if (Future.IsValid())
+	{
+		PendingRequests.Add(Key, MoveTemp(Future));
+	}
+	else
+	{
+		// Caching the empty message keeps the provider from being asked again every frame
+		Cache.Add(Key, FText::GetEmpty());
+	}
+}
+
+/**
+ * @brief Get a provided line if it is available. Completed requests are moved to the cache
+ * @param Key The line to get
+ * @param OutMessage The provided message
+ * @return A boolean value indicating if the line is available
+ */
+bool FDialogueLinePrefetcher::TryGetLine(const FDialogueLineKey& Key, FText& OutMessage)
+{
+	if (const FText* CachedMessage = Cache.FindAndTouch(Key))
+	{
+		INC_DWORD_STAT(STAT_DialogueLineCacheHits);
+		OutMessage = *CachedMessage;
+		return true;
+	}
+
+	TFuture<FText>* Future = PendingRequests.Find(Key);
+	if (Future == nullptr || !Future->IsReady())
+	{
+		return false;
+	}
+
+	OutMessage = Future->Get();
+	PendingRequests.Remove(Key);
+	Cache.Add(Key, OutMessage);
+	return true;
+}
+
+/**
+ * @brief Forget the pending requests of a conversation. The provider might still complete them, but the results
+ * are not kept. Used when the conversation ends or the player leaves its trigger
+ * @param ConversationId The stable ID of the conversation
+ */
+void FDialogueLinePrefetcher::CancelRequests(const FName ConversationId)
+{
+	for (auto It = PendingRequests.CreateIterator(); It; ++It)
+	{
+		if (It.Key().ConversationId == ConversationId)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+/**
+ * @brief Forget all the cached lines and pending requests
+ */
+void FDialogueLinePrefetcher::Reset()
+{
+	Cache.Empty(Cache.Max());
+	PendingRequests.Empty();
+}
+
+/**
+ * @brief Compare the time spent waiting for a mock provider with and without prefetching and log the result. The
+ * simulated conversations run on the core ticker one after another, so the game thread is never blocked
+ * @param NumLines The number of lines in the simulated conversation
+ * @param Latency The latency of the mock provider in seconds
+ * @param TypingTime The time in seconds spent typing every line
+ * @param PrefetchCounts The number of lines requested ahead of the current line in every simulated conversation
+ */
+void FDialogueLinePrefetcher::RunPrefetchBenchmark(const int NumLines, const float Latency, const float TypingTime,
+	const TArray<int>& PrefetchCounts)
+{
+	if (NumLines <= 0 || Latency < 0.0f || TypingTime < 0.0f || PrefetchCounts.Num() == 0
+		|| PrefetchCounts.ContainsByPredicate([](const int PrefetchCount) { return PrefetchCount < 0; }))
+	{
+		ULog::Error("DialogueLinePrefetcher::RunPrefetchBenchmark", "Invalid benchmark arguments");
+		return;
+	}
+
+	const TSharedRef<FDialoguePrefetchBenchmark> Benchmark = MakeShared<FDialoguePrefetchBenchmark>(NumLines);
+	Benchmark->Provider = NewObject<UDialogueMockLineProvider>();
+	Benchmark->Provider->Latency = Latency;
+	Benchmark->Provider->AddToRoot();
+	Benchmark->Request.ConversationId = FName("LineProviderBenchmark");
+	Benchmark->Request.FallbackMessage = FText::FromString("Benchmark");
+	Benchmark->PrefetchCounts = PrefetchCounts;
+	Benchmark->NumLines = NumLines;
+	Benchmark->Latency = Latency;
+	Benchmark->TypingTime = TypingTime;
+
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Benchmark](float)
+	{
+		return Benchmark->Tick();
+	}));
+}
\ No newline at end of file
@@ -1,6 +1,149 @@
 ﻿#include "Core/DialogueManager.h"
 #include "Blueprint/WidgetBlueprintLibrary.h"
+#include "Core/DialogueSubsystem.h"
 #include "Core/Log.h"
+#include "EngineUtils.h"
+#include "Kismet/GameplayStatics.h"
+
+/**
+ * @brief Overridable native event for when play begins for this actor
+ */
+void ADialogueManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (DialogueSubsystem != nullptr)
+	{
+		DialogueSubsystem->SetDialogueManager(this);
+	}
+
+	// Triggers that began play before this manager existed could not register themselves
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		TInlineComponentArray<UDialogueTrigger*> DialogueTriggers(*It);
+		for (UDialogueTrigger* DialogueTrigger : DialogueTriggers)
+		{
+			if (DialogueTrigger->HasBegunPlay() && DialogueTrigger->ManagerIndex == INDEX_NONE)
+			{
+				RegisterDialogueTrigger(DialogueTrigger);
+			}
+		}
+	}
+}
+
+/**
+ * @brief Overridable function called whenever this actor is being removed from a level
+ * @param EndPlayReason The reason why gameplay is ending
+ */
+void ADialogueManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (const TWeakObjectPtr<UDialogueTrigger>& Trigger : Triggers)
+	{
+		if (UDialogueTrigger* DialogueTrigger = Trigger.Get())
+		{
+			DialogueTrigger->DialogueManager = nullptr;
+			DialogueTrigger->ManagerIndex = INDEX_NONE;
+		}
+	}
+
+	Triggers.Empty();
+	OverlappedTriggers.Empty();
+	CurrentDialogueTrigger = nullptr;
+	CachedDialogueWidget = nullptr;
+
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (DialogueSubsystem != nullptr && DialogueSubsystem->GetDialogueManager() == this)
+	{
+		DialogueSubsystem->SetDialogueManager(nullptr);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+/**
+ * @brief Get the dialogue manager of the world used by the specified object
+ * @param WorldContextObject The object used to find the world
+ * @return The dialogue manager or nullptr if the world has no dialogue manager
+ */
+ADialogueManager* ADialogueManager::Get(const UObject* WorldContextObject)
+{
+	if (WorldContextObject == nullptr)
+	{
+		ULog::Error("DialogueManager::Get", "WorldContextObject is nullptr");
+		return nullptr;
+	}
+
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(WorldContextObject);
+	ADialogueManager* DialogueManager = DialogueSubsystem != nullptr ? DialogueSubsystem->GetDialogueManager() : nullptr;
+	if (DialogueManager != nullptr && DialogueManager->GetWorld() == WorldContextObject->GetWorld())
+	{
+		return DialogueManager;
+	}
+
+	// The manager might not have begun play yet, so search the world once and cache the result
+	DialogueManager = dynamic_cast<ADialogueManager*>(
+		UGameplayStatics::GetActorOfClass(WorldContextObject, ADialogueManager::StaticClass()));
+	if (DialogueManager != nullptr && DialogueSubsystem != nullptr)
+	{
+		DialogueSubsystem->SetDialogueManager(DialogueManager);
+	}
+
+	return DialogueManager;
+}
+
+/**
+ * @brief Register a dialogue trigger after it began play
+ * @param DialogueTrigger The dialogue trigger to register
+ */
+void ADialogueManager::RegisterDialogueTrigger(UDialogueTrigger* DialogueTrigger)
+{
+	if (DialogueTrigger == nullptr || DialogueTrigger->ManagerIndex != INDEX_NONE)
+	{
+		ULog::Warning("DialogueManager::RegisterDialogueTrigger", "Trigger is invalid or already registered");
+		return;
+	}
+
+	DialogueTrigger->DialogueManager = this;
+	DialogueTrigger->ManagerIndex = Triggers.Add(DialogueTrigger);
+}
+
+/**
+ * @brief Unregister a dialogue trigger before it is destroyed or streamed out. The prompt of the trigger is hidden
+ * and another trigger the player is inside takes over. A conversation that is shown continues until it is dismissed
+ * @param DialogueTrigger The dialogue trigger to unregister
+ */
+void ADialogueManager::UnregisterDialogueTrigger(UDialogueTrigger* DialogueTrigger)
+{
+	if (DialogueTrigger == nullptr || !Triggers.IsValidIndex(DialogueTrigger->ManagerIndex))
+	{
+		return;
+	}
+
+	const int RemovedIndex = DialogueTrigger->ManagerIndex;
+	Triggers.RemoveAtSwap(RemovedIndex, 1, false);
+	DialogueTrigger->ManagerIndex = INDEX_NONE;
+	DialogueTrigger->DialogueManager = nullptr;
+
+	if (Triggers.IsValidIndex(RemovedIndex))
+	{
+		if (UDialogueTrigger* MovedTrigger = Triggers[RemovedIndex].Get())
+		{
+			MovedTrigger->ManagerIndex = RemovedIndex;
+		}
+	}
+
+	ResetDialogueTrigger(DialogueTrigger);
+}
+
+/**
+ * @brief Get the number of registered dialogue triggers
+ * @return The number of registered dialogue triggers
+ */
+int ADialogueManager::GetRegisteredTriggerNum() const
+{
+	return Triggers.Num();
+}
 
 /**
  * @brief Return a boolean value indicating if the dialogue widget is currently shown
@@ -18,7 +161,15 @@ bool ADialogueManager::IsDialogueShown()
 void ADialogueManager::SetCurrentDialogueTrigger(UDialogueTrigger* DialogueTrigger)
 {
 	ULog::Info("DialogueManager::SetCurrentDialogueTrigger", "Setting dialogue trigger");
+	OverlappedTriggers.Remove(DialogueTrigger);
+	OverlappedTriggers.Add(DialogueTrigger);
 	CurrentDialogueTrigger = DialogueTrigger;
+
+	// Request the first lines while the player decides to interact, so they are usually ready when the widget opens
+	if (DialogueTrigger != nullptr)
+	{
+		DialogueTrigger->PrefetchProvidedLines(0);
+	}
 }
 
 /**
@@ -27,14 +178,44 @@ void ADialogueManager::SetCurrentDialogueTrigger(UDialogueTrigger* DialogueTrigg
  */
 void ADialogueManager::ResetDialogueTrigger(const UDialogueTrigger* DialogueTrigger)
 {
-	if (CurrentDialogueTrigger != DialogueTrigger)
+	OverlappedTriggers.RemoveAll([DialogueTrigger](const TWeakObjectPtr<UDialogueTrigger>& Trigger)
+	{
+		return !Trigger.IsValid() || Trigger.Get() == DialogueTrigger;
+	});
+
+	UDialogueTrigger* Current = CurrentDialogueTrigger.Get();
+	if (Current != nullptr && Current != DialogueTrigger)
 	{
 		ULog::Info("DialogueManager::ResetDialogueTrigger", "Reset ignored");
 		return;
 	}
 
 	ULog::Info("DialogueManager::ResetDialogueTrigger", "Resetting dialogue trigger");
+	if (Current != nullptr)
+	{
+		Current->HideInteractWidget();
+	}
+
 	CurrentDialogueTrigger = nullptr;
+	HandOffDialogueTrigger();
+}
+
+/**
+ * @brief Make the most recently entered trigger the current trigger after the current trigger was reset
+ */
+void ADialogueManager::HandOffDialogueTrigger()
+{
+	if (OverlappedTriggers.Num() == 0)
+	{
+		return;
+	}
+
+	ULog::Info("DialogueManager::HandOffDialogueTrigger", "Handing off to the previous dialogue trigger");
+	CurrentDialogueTrigger = OverlappedTriggers.Last();
+	if (!IsShown)
+	{
+		CurrentDialogueTrigger->ShowInteractWidget();
+	}
 }
 
 /**
@@ -42,7 +223,7 @@ void ADialogueManager::ResetDialogueTrigger(const UDialogueTrigger* DialogueTrig
  */
 void ADialogueManager::ShowInteractWidget()
 {
-	if (CurrentDialogueTrigger == nullptr)
+	if (!CurrentDialogueTrigger.IsValid())
 	{
 		ULog::Error("DialogueManager::ShowInteractWidget", "CurrentDialogueTrigger is nullptr");
 		return;
@@ -63,7 +244,7 @@ void ADialogueManager::ShowDialogue()
 		return;
 	}
 	
-	if (CurrentDialogueTrigger == nullptr)
+	if (!CurrentDialogueTrigger.IsValid())
 	{
 		ULog::Error("DialogueManager::ShowDialogue", "CurrentDialogueTrigger is nullptr");
 		return;
@@ -96,28 +277,112 @@ void ADialogueManager::SkipDialogueMessage()
 	DialogueWidget->SkipMessage();
 }
 
+/**
+ * @brief Pick a choice of the current line in the dialogue widget
+ * @param ChoiceIndex The index of the choice
+ */
+void ADialogueManager::SelectDialogueChoice(const int ChoiceIndex)
+{
+	if (!IsDialogueShown())
+	{
+		ULog::Warning("DialogueManager::SelectDialogueChoice", "Dialogue is not shown");
+		return;
+	}
+
+	UDialogueWidget* DialogueWidget = GetDialogueWidget();
+	if (DialogueWidget == nullptr)
+	{
+		ULog::Error("DialogueManager::SelectDialogueChoice", "Dialogue widget is nullptr");
+		return;
+	}
+
+	DialogueWidget->SelectChoice(ChoiceIndex);
+}
+
+/**
+ * @brief Move the selection in the choice menu of the dialogue widget
+ * @param Offset The number of choices to move. Negative values move up
+ */
+void ADialogueManager::NavigateDialogueChoice(const int Offset)
+{
+	UDialogueWidget* DialogueWidget = IsDialogueShown() ? GetDialogueWidget() : nullptr;
+	if (DialogueWidget != nullptr)
+	{
+		DialogueWidget->NavigateChoices(Offset);
+	}
+}
+
 /**
  * @brief Clean up the UI after the dialogue widget is dismissed
  */
 void ADialogueManager::OnDialogueDismissed()
 {
-	if (CurrentDialogueTrigger == nullptr)
+	ULog::Info("DialogueManager::OnDialogueDismissed", "Dialogue was dismissed");
+	IsShown = false;
+
+	// The trigger of the conversation might have streamed out while the conversation was shown
+	if (!CurrentDialogueTrigger.IsValid())
 	{
-		ULog::Error("DialogueManager::OnDialogueDismissed", "CurrentDialogueTrigger is nullptr");
+		ULog::Info("DialogueManager::OnDialogueDismissed", "CurrentDialogueTrigger is no longer valid");
+		CurrentDialogueTrigger = nullptr;
 		return;
 	}
-	
-	ULog::Info("DialogueManager::OnDialogueDismissed", "Dialogue was dismissed");
+
 	CurrentDialogueTrigger->ShowInteractWidget();
-	IsShown = false;
 }
 
 /**
- * @brief Get a reference to the dialogue widget 
+ * @brief Restore the dialogue widget after loading a save using the active conversation of the dialogue subsystem
+ */
+void ADialogueManager::RestoreDialogue()
+{
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	UDialogueWidget* DialogueWidget = GetDialogueWidget();
+	if (DialogueSubsystem == nullptr || DialogueWidget == nullptr)
+	{
+		ULog::Error("DialogueManager::RestoreDialogue", "DialogueSubsystem or dialogue widget is nullptr");
+		return;
+	}
+
+	const FDialogueActiveState ActiveState = DialogueSubsystem->GetActiveState();
+	UDialogueTrigger* DialogueTrigger = DialogueSubsystem->GetConversationSource(ActiveState.Conversation);
+	if (DialogueTrigger == nullptr)
+	{
+		ULog::Info("DialogueManager::RestoreDialogue", "No active conversation to restore");
+		DialogueWidget->SetVisibility(ESlateVisibility::Collapsed);
+		IsShown = false;
+		return;
+	}
+
+	ULog::Info("DialogueManager::RestoreDialogue", "Restoring dialogue");
+	if (!DialogueWidget->RestoreConversation(ActiveState.Conversation, DialogueTrigger->GetPreparedConversation(),
+		DialogueTrigger->DialogueVoices, ActiveState.Line, ActiveState.TypingIndex))
+	{
+		// The trigger can have fewer lines than the save recorded. The saved line is dropped so dialogue can be shown again
+		ULog::Warning("DialogueManager::RestoreDialogue", "The active conversation does not match its trigger");
+		DialogueWidget->SetVisibility(ESlateVisibility::Collapsed);
+		DialogueSubsystem->ClearActiveLine();
+		CurrentDialogueTrigger = nullptr;
+		IsShown = false;
+		return;
+	}
+
+	CurrentDialogueTrigger = DialogueTrigger;
+	CurrentDialogueTrigger->HideInteractWidget();
+	IsShown = true;
+}
+
+/**
+ * @brief Get a reference to the dialogue widget. The widget is only searched when the cached widget is not valid
  * @return A reference to the dialogue widget
  */
-UDialogueWidget* ADialogueManager::GetDialogueWidget() const
+UDialogueWidget* ADialogueManager::GetDialogueWidget()
 {
+	if (UDialogueWidget* DialogueWidget = CachedDialogueWidget.Get())
+	{
+		return DialogueWidget;
+	}
+
 	TArray<UUserWidget*> DialogueWidgets;
 	UWidgetBlueprintLibrary::GetAllWidgetsOfClass(GetWorld(), DialogueWidgets, UDialogueWidget::StaticClass(), false);
 
@@ -126,6 +391,7 @@ UDialogueWidget* ADialogueManager::GetDialogueWidget() const
 		UDialogueWidget* DialogueWidget = dynamic_cast<UDialogueWidget*>(Widget);
 		if (DialogueWidget != nullptr)
 		{
+			CachedDialogueWidget = DialogueWidget;
 			return DialogueWidget;
 		}
 	}
@@ -0,0 +1,36 @@
+﻿#include "Core/DialogueMockLineProvider.h"
+#include "Async/Future.h"
+#include "Containers/Ticker.h"
+
+UDialogueMockLineProvider::UDialogueMockLineProvider()
+{
+	Latency = 0.2f;
+	LatencyJitter = 0.0f;
+	MessageFormat = FText::FromString("{Message}");
+}
+
+/**
+ * @brief Request the message of a line. The message is completed by the core ticker after the latency
+ * @param Request The line that is requested
+ * @return The message of the line
+ */
+TFuture<FText> UDialogueMockLineProvider::RequestLine(const FDialogueLineRequest& Request)
+{
+	FFormatNamedArguments Arguments;
+	Arguments.Add(TEXT("Message"), Request.FallbackMessage);
+	Arguments.Add(TEXT("Line"), FText::AsNumber(Request.Line));
+	Arguments.Add(TEXT("Context"), FText::FromName(Request.Context));
+
+	const FText Message = FText::Format(MessageFormat, Arguments);
+	const float Delay = FMath::Max(Latency + FMath::FRandRange(-LatencyJitter, LatencyJitter), 0.0f);
+
+	// The latency is waited on the core ticker, so pending and cancelled requests don't occupy worker threads
+	const TSharedRef<TPromise<FText>, ESPMode::ThreadSafe> Promise = MakeShared<TPromise<FText>, ESPMode::ThreadSafe>();
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([Promise, Message](float)
+	{
+		Promise->SetValue(Message);
+		return false;
+	}), Delay);
+
+	return Promise->GetFuture();
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+﻿#include "Core/DialoguePreparedConversation.h"
+#include "Algo/IsSorted.h"
+
+/**
+ * @brief Format and preprocess the text of a conversation. Can be called from any thread
+ * @param Source The data copied from the dialogue trigger
+ * @param Cancelled Checked between lines. Preparation stops early when it is set
+ * @return The prepared conversation or nullptr if the preparation was cancelled
+ */
+TSharedPtr<const FDialoguePreparedConversation, ESPMode::ThreadSafe> FDialoguePreparedConversation::Prepare(
+	FDialoguePreparationSource&& Source, const std::atomic<bool>* Cancelled)
+{
+	const TSharedRef<FDialoguePreparedConversation, ESPMode::ThreadSafe> Prepared =
+		MakeShared<FDialoguePreparedConversation, ESPMode::ThreadSafe>();
+	Prepared->Titles = MoveTemp(Source.Titles);
+	Prepared->Messages = MoveTemp(Source.Messages);
+	Prepared->Choices = MoveTemp(Source.Choices);
+	Prepared->Cues = MoveTemp(Source.Cues);
+	Prepared->Culture = MoveTemp(Source.Culture);
+
+	// Unformatted text is kept as is, so it still follows the culture when it changes
+	const bool Format = Source.Arguments.Num() > 0;
+	Prepared->MessageStrings.Reserve(Prepared->Messages.Num());
+	for (int Line = 0; Line < Prepared->Messages.Num(); Line++)
+	{
+		if (Cancelled != nullptr && Cancelled->load(std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+
+		if (Format)
+		{
+			Prepared->Messages[Line] = FText::Format(Prepared->Messages[Line], Source.Arguments);
+			if (Prepared->Titles.IsValidIndex(Line))
+			{
+				Prepared->Titles[Line] = FText::Format(Prepared->Titles[Line], Source.Arguments);
+			}
+		}
+
+		Prepared->MessageStrings.Add(Prepared->Messages[Line].ToString());
+	}
+
+	for (FDialogueChoiceSet& ChoiceSet : Prepared->Choices)
+	{
+		for (FDialogueChoice& Choice : ChoiceSet.Choices)
+		{
+			if (Format)
+			{
+				Choice.Text = FText::Format(Choice.Text, Source.Arguments);
+			}
+		}
+	}
+
+	// The typing animation steps through the cues with a cursor, which requires every track to be sorted. Tracks
+	// that mix units are sorted for the prepared message and sorted again by the widget when the message changes
+	for (int Line = 0; Line < Prepared->Cues.Num(); Line++)
+	{
+		const int MessageLength = Prepared->MessageStrings.IsValidIndex(Line)
+			? Prepared->MessageStrings[Line].Len()
+			: 0;
+		const auto CharacterOffset = [MessageLength](const FDialogueCue& Cue)
+		{
+			return Cue.GetCharacterOffset(MessageLength);
+		};
+
+		TArray<FDialogueCue>& Track = Prepared->Cues[Line].Cues;
+		if (!Algo::IsSortedBy(Track, CharacterOffset))
+		{
+			Track.StableSort([&CharacterOffset](const FDialogueCue& A, const FDialogueCue& B)
+			{
+				return CharacterOffset(A) < CharacterOffset(B);
+			});
+		}
+	}
+
+	return Prepared;
+}
+
+/**
+ * @brief Get a conversation without lines
+ * @return The empty conversation
+ */
+const FDialoguePreparedConversation& FDialoguePreparedConversation::GetEmpty()
+{
+	static const FDialoguePreparedConversation Empty;
+	return Empty;
+}
\ No newline at end of file
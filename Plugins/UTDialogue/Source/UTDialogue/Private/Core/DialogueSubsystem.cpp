@@ -0,0 +1,936 @@
+﻿#include "Core/DialogueSubsystem.h"
+#include "Components/DialogueTrigger.h"
+#include "Core/DialogueStats.h"
+#include "Core/DialogueTelemetry.h"
+#include "Core/Log.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/CoreDelegates.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UI/DialogueWidget.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Input Latency Samples"), STAT_DialogueInputLatencySamples, STATGROUP_UTDialogue);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Input Latency Last (ms)"), STAT_DialogueInputLatencyLast, STATGROUP_UTDialogue);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Input Latency P50 (ms)"), STAT_DialogueInputLatencyP50, STATGROUP_UTDialogue);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Input Latency P95 (ms)"), STAT_DialogueInputLatencyP95, STATGROUP_UTDialogue);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Input Latency P99 (ms)"), STAT_DialogueInputLatencyP99, STATGROUP_UTDialogue);
+
+static FAutoConsoleCommandWithWorldAndArgs InputLatencyCommand(
+	TEXT("UTDialogue.Input.Latency"),
+	TEXT("Log the percentiles of the time between a skip input and the first visible change of the message. ")
+	TEXT("Usage: UTDialogue.Input.Latency [BudgetMs|Reset]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(World);
+		if (DialogueSubsystem == nullptr)
+		{
+			ULog::Error("DialogueSubsystem::InputLatencyCommand", "DialogueSubsystem is nullptr");
+			return;
+		}
+
+		if (Args.Num() > 0 && Args[0].Equals(TEXT("Reset"), ESearchCase::IgnoreCase))
+		{
+			DialogueSubsystem->ResetInputLatency();
+			return;
+		}
+
+		DialogueSubsystem->LogInputLatency(Args.Num() > 0 ? FCString::Atof(*Args[0]) : 100.0f);
+	}));
+
+/**
+ * @brief The default maximum number of lines stored in the history
+ */
+static constexpr int DefaultHistoryCapacity = 1024;
+
+/**
+ * @brief The magic number at the start of every saved dialogue state ("UTDS")
+ */
+static constexpr uint32 DialogueSaveMagic = 0x53445455;
+
+/**
+ * @brief The maximum number of lines in a saved dialogue state. Larger values are rejected as corrupt data
+ */
+static constexpr int MaxSavedLines = 1 << 24;
+
+/**
+ * @brief The maximum number of conversations in a saved dialogue state. Larger handles are rejected as corrupt data
+ */
+static constexpr int MaxSavedConversations = 1 << 16;
+
+/**
+ * @brief The versions of the saved dialogue state
+ */
+enum class EDialogueSaveVersion : uint16
+{
+	Initial = 1,
+
+	LatestPlusOne,
+	Latest = LatestPlusOne - 1
+};
+
+/**
+ * @brief The sections of the saved dialogue state. Sections are only written when they changed
+ */
+enum class EDialogueSaveSection : uint8
+{
+	End = 0,
+	Conversations = 1,
+	Active = 2,
+	Variables = 3,
+	SeenLines = 4
+};
+
+/**
+ * @brief Serialize a non-negative integer using a variable number of bytes
+ * @param Ar The archive used to serialize the integer
+ * @param Value The integer to serialize
+ */
+static void SerializePacked(FArchive& Ar, int& Value)
+{
+	uint32 PackedValue = static_cast<uint32>(FMath::Max(Value, 0));
+	Ar.SerializeIntPacked(PackedValue);
+	if (Ar.IsLoading() && PackedValue > static_cast<uint32>(MAX_int32))
+	{
+		Ar.SetError();
+		PackedValue = 0;
+	}
+
+	Value = static_cast<int>(PackedValue);
+}
+
+/**
+ * @brief Check if the remaining bytes of an archive can hold the specified number of entries
+ * @param Ar The archive used to read the entries
+ * @param Count The number of entries
+ * @param MinEntrySize The minimum size of an entry in bytes
+ * @return A boolean value indicating if the count is valid
+ */
+static bool IsCountValid(FArchive& Ar, const int Count, const int MinEntrySize)
+{
+	return Count >= 0 && static_cast<int64>(Count) * MinEntrySize <= Ar.TotalSize() - Ar.Tell();
+}
+
+/**
+ * @brief Initialize the subsystem
+ * @param Collection The collection of subsystems
+ */
+void UDialogueSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	History.SetCapacity(DefaultHistoryCapacity);
+	FrameStartTime = FPlatformTime::Seconds();
+	BeginFrameHandle = FCoreDelegates::OnBeginFrame.AddUObject(this, &UDialogueSubsystem::OnBeginFrame);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("DialogueTelemetry")) && !FDialogueTelemetry::Get().IsRunning())
+	{
+		FDialogueTelemetry::Get().Start();
+	}
+}
+
+/**
+ * @brief Deinitialize the subsystem and close the telemetry log
+ */
+void UDialogueSubsystem::Deinitialize()
+{
+	FCoreDelegates::OnBeginFrame.Remove(BeginFrameHandle);
+	FDialogueTelemetry::Get().Stop();
+	Super::Deinitialize();
+}
+
+/**
+ * @brief Store the time when the frame started
+ */
+void UDialogueSubsystem::OnBeginFrame()
+{
+	FrameStartTime = FPlatformTime::Seconds();
+}
+
+/**
+ * @brief Get the dialogue subsystem of the game instance used by the specified object
+ * @param WorldContextObject The object used to find the game instance
+ * @return The dialogue subsystem or nullptr if the game instance is not valid
+ */
+UDialogueSubsystem* UDialogueSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UGameInstance* GameInstance = UGameplayStatics::GetGameInstance(WorldContextObject);
+	return GameInstance == nullptr ? nullptr : GameInstance->GetSubsystem<UDialogueSubsystem>();
+}
+
+/**
+ * @brief Get the dialogue manager of the current world
+ * @return The dialogue manager or nullptr if no dialogue manager began play
+ */
+ADialogueManager* UDialogueSubsystem::GetDialogueManager() const
+{
+	return CachedDialogueManager.Get();
+}
+
+/**
+ * @brief Change the dialogue manager of the current world
+ * @param DialogueManager The dialogue manager or nullptr to clear it
+ */
+void UDialogueSubsystem::SetDialogueManager(ADialogueManager* DialogueManager)
+{
+	CachedDialogueManager = DialogueManager;
+}
+
+/**
+ * @brief Get the prefetcher used to request lines from line providers
+ * @return The prefetcher shared by all the conversations
+ */
+FDialogueLinePrefetcher& UDialogueSubsystem::GetLinePrefetcher()
+{
+	return LinePrefetcher;
+}
+
+/**
+ * @brief Get the time when the current frame started. Unlike the application time it is not advanced by a fixed
+ * time step, so it can be compared with FPlatformTime::Seconds
+ * @return The time in seconds when the current frame started
+ */
+double UDialogueSubsystem::GetFrameStartTime() const
+{
+	return FrameStartTime;
+}
+
+/**
+ * @brief Record the time between a skip input and the first visible change of the message
+ * @param Milliseconds The latency in milliseconds
+ */
+void UDialogueSubsystem::RecordInputLatency(const float Milliseconds)
+{
+	InputLatency.Add(Milliseconds);
+	INC_DWORD_STAT(STAT_DialogueInputLatencySamples);
+	SET_FLOAT_STAT(STAT_DialogueInputLatencyLast, Milliseconds);
+	SET_FLOAT_STAT(STAT_DialogueInputLatencyP50, InputLatency.GetPercentile(50.0f));
+	SET_FLOAT_STAT(STAT_DialogueInputLatencyP95, InputLatency.GetPercentile(95.0f));
+	SET_FLOAT_STAT(STAT_DialogueInputLatencyP99, InputLatency.GetPercentile(99.0f));
+}
+
+/**
+ * @brief Get the histogram of the time between a skip input and the first visible change of the message
+ * @return The input latency histogram
+ */
+const FDialogueLatencyHistogram& UDialogueSubsystem::GetInputLatency() const
+{
+	return InputLatency;
+}
+
+/**
+ * @brief Remove all the recorded input latencies
+ */
+void UDialogueSubsystem::ResetInputLatency()
+{
+	ULog::Info("DialogueSubsystem::ResetInputLatency", "Resetting input latency");
+	InputLatency.Reset();
+}
+
+/**
+ * @brief Log the percentiles of the recorded input latencies
+ * @param BudgetMilliseconds The latency budget in milliseconds. The fraction of inputs over the budget is logged
+ */
+void UDialogueSubsystem::LogInputLatency(const float BudgetMilliseconds) const
+{
+	ULog::Info("DialogueSubsystem::LogInputLatency", FString::Printf(
+		TEXT("Samples = %d, P50 = %.2f ms, P90 = %.2f ms, P95 = %.2f ms, P99 = %.2f ms, Max = %.2f ms, ")
+		TEXT("Over %.1f ms budget = %.1f%%"), InputLatency.Num(), InputLatency.GetPercentile(50.0f),
+		InputLatency.GetPercentile(90.0f), InputLatency.GetPercentile(95.0f), InputLatency.GetPercentile(99.0f),
+		InputLatency.GetMax(), BudgetMilliseconds, InputLatency.GetFractionAbove(BudgetMilliseconds) * 100.0f));
+}
+
+/**
+ * @brief Register a conversation. Registering the same conversation again updates the source trigger
+ * @param Trigger The trigger that contains the text of the conversation
+ * @return The handle of the conversation
+ */
+int UDialogueSubsystem::RegisterConversation(UDialogueTrigger* Trigger)
+{
+	if (Trigger == nullptr)
+	{
+		ULog::Error("DialogueSubsystem::RegisterConversation", "Trigger is nullptr");
+		return INDEX_NONE;
+	}
+
+	const FName ConversationId = Trigger->GetConversationId();
+	const int LineCount = Trigger->DialogueMessages.Num();
+
+	int Conversation = FindConversation(ConversationId);
+	if (Conversation == INDEX_NONE)
+	{
+		Conversation = AddConversation(ConversationId, LineCount);
+	}
+	else if (Conversations[Conversation].LineCount < LineCount)
+	{
+		GrowConversation(Conversation, LineCount);
+	}
+
+	Conversations[Conversation].Source = Trigger;
+	return Conversation;
+}
+
+/**
+ * @brief Find the handle of the specified conversation
+ * @param ConversationId The stable ID of the conversation
+ * @return The handle of the conversation or -1 if the conversation is not registered
+ */
+int UDialogueSubsystem::FindConversation(const FName ConversationId) const
+{
+	const int* Conversation = ConversationLookup.Find(ConversationId);
+	return Conversation == nullptr ? INDEX_NONE : *Conversation;
+}
+
+/**
+ * @brief Get the trigger that contains the text of the specified conversation
+ * @param Conversation The handle of the conversation
+ * @return The trigger or nullptr if the trigger is not loaded
+ */
+UDialogueTrigger* UDialogueSubsystem::GetConversationSource(const int Conversation) const
+{
+	return Conversations.IsValidIndex(Conversation) ? Conversations[Conversation].Source.Get() : nullptr;
+}
+
+/**
+ * @brief Get the ID used to identify the specified conversation in the telemetry
+ * @param Conversation The handle of the conversation
+ * @return The telemetry ID or 0 if the conversation is not registered
+ */
+uint32 UDialogueSubsystem::GetTelemetryId(const int Conversation) const
+{
+	return Conversations.IsValidIndex(Conversation) ? Conversations[Conversation].TelemetryId : 0;
+}
+
+/**
+ * @brief Get the title of the specified line
+ * @param Conversation The handle of the conversation
+ * @param Line The index of the line
+ * @return The title of the line or empty text if the line is not loaded
+ */
+FText UDialogueSubsystem::GetLineTitle(const int Conversation, const int Line) const
+{
+	const UDialogueTrigger* Source = GetConversationSource(Conversation);
+	if (Source == nullptr || !Source->DialogueTitles.IsValidIndex(Line))
+	{
+		return FText::GetEmpty();
+	}
+
+	return Source->DialogueTitles[Line];
+}
+
+/**
+ * @brief Get the message of the specified line
+ * @param Conversation The handle of the conversation
+ * @param Line The index of the line
+ * @return The message of the line or empty text if the line is not loaded
+ */
+FText UDialogueSubsystem::GetLineMessage(const int Conversation, const int Line) const
+{
+	const UDialogueTrigger* Source = GetConversationSource(Conversation);
+	if (Source == nullptr || !Source->DialogueMessages.IsValidIndex(Line))
+	{
+		return FText::GetEmpty();
+	}
+
+	return Source->DialogueMessages[Line];
+}
+
+/**
+ * @brief Add a line to the dialogue history. The oldest line is removed when the history is full
+ * @param Conversation The handle of the conversation
+ * @param Line The index of the line
+ */
+void UDialogueSubsystem::AddToHistory(const int Conversation, const int Line)
+{
+	FDialogueHistoryEntry Entry;
+	Entry.Conversation = Conversation;
+	Entry.Line = Line;
+	History.Add(Entry);
+}
+
+/**
+ * @brief Change the maximum number of lines stored in the history. The current history is cleared
+ * @param Capacity The maximum number of lines stored in the history
+ */
+void UDialogueSubsystem::SetHistoryCapacity(const int Capacity)
+{
+	ULog::Info("DialogueSubsystem::SetHistoryCapacity", FString("Capacity = ").Append(FString::FromInt(Capacity)));
+	History.SetCapacity(Capacity);
+}
+
+/**
+ * @brief Remove all the lines from the history
+ */
+void UDialogueSubsystem::ClearHistory()
+{
+	History.Reset();
+}
+
+/**
+ * @brief Get the number of lines in the history
+ * @return The number of lines in the history
+ */
+int UDialogueSubsystem::GetHistoryNum() const
+{
+	return History.Num();
+}
+
+/**
+ * @brief Get a line from the history
+ * @param Index The index of the line. Index 0 is the oldest line in the history
+ * @return The line at the specified index
+ */
+const FDialogueHistoryEntry& UDialogueSubsystem::GetHistoryEntry(const int Index) const
+{
+	return History[Index];
+}
+
+/**
+ * @brief Mark the specified line as seen
+ * @param Conversation The handle of the conversation
+ * @param Line The index of the line
+ */
+void UDialogueSubsystem::MarkLineSeen(const int Conversation, const int Line)
+{
+	if (!Conversations.IsValidIndex(Conversation) || Line < 0 || Line >= Conversations[Conversation].LineCount)
+	{
+		return;
+	}
+
+	SeenLines.Set(Conversations[Conversation].FirstLine + Line);
+}
+
+/**
+ * @brief Check if the specified line was seen. The line is looked up in the seen-line bitset in constant time
+ * @param Conversation The handle of the conversation
+ * @param Line The index of the line
+ * @return A boolean value indicating if the line was seen
+ */
+bool UDialogueSubsystem::IsLineSeen(const int Conversation, const int Line) const
+{
+	if (!Conversations.IsValidIndex(Conversation) || Line < 0 || Line >= Conversations[Conversation].LineCount)
+	{
+		return false;
+	}
+
+	return SeenLines.Get(Conversations[Conversation].FirstLine + Line);
+}
+
+/**
+ * @brief Check if the specified line was seen
+ * @param ConversationId The stable ID of the conversation
+ * @param Line The index of the line
+ * @return A boolean value indicating if the line was seen
+ */
+bool UDialogueSubsystem::HasSeenLine(const FName ConversationId, const int Line) const
+{
+	return IsLineSeen(FindConversation(ConversationId), Line);
+}
+
+/**
+ * @brief Get the number of lines tracked by the seen-line bitset
+ * @return The number of lines tracked by the seen-line bitset
+ */
+int UDialogueSubsystem::GetTrackedLineNum() const
+{
+	return SeenLines.Num();
+}
+
+/**
+ * @brief Update the conversation that is currently shown in the dialogue widget
+ * @param Widget The dialogue widget showing the conversation
+ * @param Conversation The handle of the conversation
+ * @param Line The index of the current line
+ */
+void UDialogueSubsystem::SetActiveLine(UDialogueWidget* Widget, const int Conversation, const int Line)
+{
+	ActiveWidget = Widget;
+	ActiveState.Conversation = Conversation;
+	ActiveState.Line = Line;
+	ActiveState.TypingIndex = 0;
+	ActiveStateDirty = true;
+}
+
+/**
+ * @brief Clear the active conversation after the dialogue widget is dismissed
+ */
+void UDialogueSubsystem::ClearActiveLine()
+{
+	ActiveWidget = nullptr;
+	ActiveState = FDialogueActiveState();
+	ActiveStateDirty = true;
+}
+
+/**
+ * @brief Get the conversation that is currently shown or was restored by the last load
+ * @return The active conversation
+ */
+FDialogueActiveState UDialogueSubsystem::GetActiveState() const
+{
+	FDialogueActiveState State = ActiveState;
+	if (const UDialogueWidget* Widget = ActiveWidget.Get())
+	{
+		State.TypingIndex = Widget->GetRevealedCharacters();
+	}
+
+	return State;
+}
+
+/**
+ * @brief Set the value of a dialogue variable
+ * @param Name The name of the variable
+ * @param Value The new value of the variable
+ */
+void UDialogueSubsystem::SetDialogueVariable(const FName Name, const int Value)
+{
+	const int* CurrentValue = Variables.Find(Name);
+	if (CurrentValue != nullptr && *CurrentValue == Value)
+	{
+		return;
+	}
+
+	Variables.Add(Name, Value);
+	DirtyVariables.Add(Name);
+}
+
+/**
+ * @brief Get the value of a dialogue variable
+ * @param Name The name of the variable
+ * @return The value of the variable or 0 if the variable is not set
+ */
+int UDialogueSubsystem::GetDialogueVariable(const FName Name) const
+{
+	const int* Value = Variables.Find(Name);
+	return Value == nullptr ? 0 : *Value;
+}
+
+/**
+ * @brief Save the dialogue state using a compact binary format
+ * @param OutData The saved data
+ * @param Incremental Only save the state that changed since the last save?
+ * @return A boolean value indicating if the state was saved
+ */
+bool UDialogueSubsystem::SaveDialogueState(TArray<uint8>& OutData, const bool Incremental)
+{
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+
+	uint32 Magic = DialogueSaveMagic;
+	uint16 Version = static_cast<uint16>(EDialogueSaveVersion::Latest);
+	uint8 IsIncremental = Incremental ? 1 : 0;
+	Writer << Magic << Version << IsIncremental;
+
+	WriteState(Writer, Incremental);
+	if (Writer.IsError())
+	{
+		ULog::Error("DialogueSubsystem::SaveDialogueState", "Failed to write the dialogue state");
+		return false;
+	}
+
+	ClearDirtyState();
+	ULog::Trace("DialogueSubsystem::SaveDialogueState", FString("Bytes = ").Append(FString::FromInt(OutData.Num())));
+	return true;
+}
+
+/**
+ * @brief Load the dialogue state. A full save replaces the current state and an incremental save is applied on top
+ * @param Data The saved data
+ * @return A boolean value indicating if the state was loaded
+ */
+bool UDialogueSubsystem::LoadDialogueState(const TArray<uint8>& Data)
+{
+	FMemoryReader Reader(Data);
+
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	uint8 IsIncremental = 0;
+	Reader << Magic << Version << IsIncremental;
+
+	if (Reader.IsError() || Magic != DialogueSaveMagic || Version > static_cast<uint16>(EDialogueSaveVersion::Latest))
+	{
+		ULog::Error("DialogueSubsystem::LoadDialogueState", "Invalid or unsupported dialogue state");
+		return false;
+	}
+
+	// The state is read in place, so the previous state is kept aside and put back when the data is corrupt
+	TArray<FDialogueConversation> PreviousConversations = Conversations;
+	TMap<FName, int> PreviousConversationLookup = ConversationLookup;
+	FDialogueLineBitset PreviousSeenLines = SeenLines;
+	TMap<FName, int> PreviousVariables = Variables;
+	const FDialogueActiveState PreviousActiveState = ActiveState;
+	const TWeakObjectPtr<UDialogueWidget> PreviousActiveWidget = ActiveWidget;
+
+	TArray<TPair<FName, TWeakObjectPtr<UDialogueTrigger>>> LoadedSources;
+	if (IsIncremental == 0)
+	{
+		for (const FDialogueConversation& Conversation : Conversations)
+		{
+			if (Conversation.Source.IsValid())
+			{
+				LoadedSources.Add(TPair<FName, TWeakObjectPtr<UDialogueTrigger>>(Conversation.Id, Conversation.Source));
+			}
+		}
+
+		Conversations.Reset();
+		ConversationLookup.Reset();
+		SeenLines.Empty();
+		Variables.Reset();
+		ActiveState = FDialogueActiveState();
+		ActiveWidget = nullptr;
+	}
+
+	if (!ReadState(Reader))
+	{
+		ULog::Error("DialogueSubsystem::LoadDialogueState", "Failed to read the dialogue state");
+		Conversations = MoveTemp(PreviousConversations);
+		ConversationLookup = MoveTemp(PreviousConversationLookup);
+		SeenLines = MoveTemp(PreviousSeenLines);
+		Variables = MoveTemp(PreviousVariables);
+		ActiveState = PreviousActiveState;
+		ActiveWidget = PreviousActiveWidget;
+		return false;
+	}
+
+	if (IsIncremental == 0)
+	{
+		History.Reset();
+	}
+
+	for (const TPair<FName, TWeakObjectPtr<UDialogueTrigger>>& LoadedSource : LoadedSources)
+	{
+		RegisterConversation(LoadedSource.Value.Get());
+	}
+
+	ClearDirtyState();
+	return true;
+}
+
+/**
+ * @brief Add a conversation and reserve its lines in the seen-line bitset
+ * @param ConversationId The stable ID of the conversation
+ * @param LineCount The number of lines in the conversation
+ * @return The handle of the conversation
+ */
+int UDialogueSubsystem::AddConversation(const FName ConversationId, const int LineCount)
+{
+	FDialogueConversation NewConversation;
+	NewConversation.Id = ConversationId;
+	NewConversation.FirstLine = SeenLines.Num();
+	NewConversation.LineCount = LineCount;
+	SeenLines.SetNum(SeenLines.Num() + LineCount);
+	RegisterTelemetryId(NewConversation);
+
+	const int Conversation = Conversations.Add(NewConversation);
+	ConversationLookup.Add(ConversationId, Conversation);
+	return Conversation;
+}
+
+/**
+ * @brief Set the telemetry ID of a conversation from its stable ID and register the name with the telemetry
+ * @param Conversation The conversation to update
+ */
+void UDialogueSubsystem::RegisterTelemetryId(FDialogueConversation& Conversation)
+{
+	const FString IdString = Conversation.Id.ToString();
+	Conversation.TelemetryId = FCrc::StrCrc32(*IdString);
+	FDialogueTelemetry::Get().RegisterName(Conversation.TelemetryId, IdString);
+}
+
+/**
+ * @brief Move a conversation to a larger range in the seen-line bitset and keep the seen lines
+ * @param Conversation The handle of the conversation
+ * @param LineCount The new number of lines in the conversation
+ */
+void UDialogueSubsystem::GrowConversation(const int Conversation, const int LineCount)
+{
+	FDialogueConversation& GrownConversation = Conversations[Conversation];
+	const int OldFirstLine = GrownConversation.FirstLine;
+	const int OldLineCount = GrownConversation.LineCount;
+
+	GrownConversation.FirstLine = SeenLines.Num();
+	GrownConversation.LineCount = LineCount;
+	GrownConversation.Dirty = true;
+	SeenLines.SetNum(SeenLines.Num() + LineCount);
+
+	for (int Line = 0; Line < OldLineCount; Line++)
+	{
+		if (SeenLines.Get(OldFirstLine + Line))
+		{
+			SeenLines.Set(GrownConversation.FirstLine + Line);
+		}
+	}
+}
+
+/**
+ * @brief Serialize the sections of the dialogue state
+ * @param Ar The archive used to write the state
+ * @param Incremental Only write the state that changed since the last save?
+ */
+void UDialogueSubsystem::WriteState(FArchive& Ar, const bool Incremental)
+{
+	TArray<int> ChangedConversations;
+	for (int Conversation = 0; Conversation < Conversations.Num(); Conversation++)
+	{
+		if (!Incremental || Conversations[Conversation].Dirty)
+		{
+			ChangedConversations.Add(Conversation);
+		}
+	}
+
+	if (ChangedConversations.Num() > 0)
+	{
+		uint8 Section = static_cast<uint8>(EDialogueSaveSection::Conversations);
+		int Count = ChangedConversations.Num();
+		int NumLines = SeenLines.Num();
+		Ar << Section;
+		SerializePacked(Ar, NumLines);
+		SerializePacked(Ar, Count);
+
+		for (int Conversation : ChangedConversations)
+		{
+			FDialogueConversation& ChangedConversation = Conversations[Conversation];
+			SerializePacked(Ar, Conversation);
+			Ar << ChangedConversation.Id;
+			SerializePacked(Ar, ChangedConversation.FirstLine);
+			SerializePacked(Ar, ChangedConversation.LineCount);
+		}
+	}
+
+	FDialogueActiveState State = GetActiveState();
+	if (!Incremental || ActiveStateDirty || State.TypingIndex != ActiveState.TypingIndex)
+	{
+		ActiveState.TypingIndex = State.TypingIndex;
+
+		uint8 Section = static_cast<uint8>(EDialogueSaveSection::Active);
+		uint8 HasConversation = Conversations.IsValidIndex(State.Conversation) ? 1 : 0;
+		Ar << Section << HasConversation;
+
+		if (HasConversation != 0)
+		{
+			int RevealedCharacters = State.TypingIndex + 1;
+			Ar << Conversations[State.Conversation].Id;
+			SerializePacked(Ar, State.Line);
+			SerializePacked(Ar, RevealedCharacters);
+		}
+	}
+
+	TArray<FName> ChangedVariables;
+	if (Incremental)
+	{
+		ChangedVariables = DirtyVariables.Array();
+	}
+	else
+	{
+		Variables.GetKeys(ChangedVariables);
+	}
+
+	if (ChangedVariables.Num() > 0)
+	{
+		uint8 Section = static_cast<uint8>(EDialogueSaveSection::Variables);
+		int Count = ChangedVariables.Num();
+		Ar << Section;
+		SerializePacked(Ar, Count);
+
+		for (FName& Name : ChangedVariables)
+		{
+			int32 Value = GetDialogueVariable(Name);
+			Ar << Name << Value;
+		}
+	}
+
+	TArray<int> ChangedWords;
+	if (Incremental)
+	{
+		ChangedWords = SeenLines.GetDirtyWords();
+	}
+	else
+	{
+		for (int WordIndex = 0; WordIndex < SeenLines.NumWords(); WordIndex++)
+		{
+			if (SeenLines.GetWord(WordIndex) != 0)
+			{
+				ChangedWords.Add(WordIndex);
+			}
+		}
+	}
+
+	if (ChangedWords.Num() > 0)
+	{
+		uint8 Section = static_cast<uint8>(EDialogueSaveSection::SeenLines);
+		int Count = ChangedWords.Num();
+		Ar << Section;
+		SerializePacked(Ar, Count);
+
+		for (int WordIndex : ChangedWords)
+		{
+			uint32 Word = SeenLines.GetWord(WordIndex);
+			SerializePacked(Ar, WordIndex);
+			Ar << Word;
+		}
+	}
+
+	uint8 EndSection = static_cast<uint8>(EDialogueSaveSection::End);
+	Ar << EndSection;
+}
+
+/**
+ * @brief Deserialize the sections of the dialogue state
+ * @param Ar The archive used to read the state
+ * @return A boolean value indicating if the state was read without errors
+ */
+bool UDialogueSubsystem::ReadState(FArchive& Ar)
+{
+	while (!Ar.IsError() && !Ar.AtEnd())
+	{
+		uint8 Section = 0;
+		Ar << Section;
+
+		switch (static_cast<EDialogueSaveSection>(Section))
+		{
+		case EDialogueSaveSection::End:
+			return !Ar.IsError();
+		case EDialogueSaveSection::Conversations:
+			{
+				int NumLines = 0;
+				int Count = 0;
+				SerializePacked(Ar, NumLines);
+				SerializePacked(Ar, Count);
+
+				// An entry has at least a packed handle, the length of the ID and two packed line numbers
+				if (Ar.IsError() || NumLines > MaxSavedLines || !IsCountValid(Ar, Count, 7))
+				{
+					ULog::Error("DialogueSubsystem::ReadState", "Invalid conversation section");
+					return false;
+				}
+
+				SeenLines.SetNum(FMath::Max(SeenLines.Num(), NumLines));
+
+				for (int Entry = 0; Entry < Count && !Ar.IsError(); Entry++)
+				{
+					int Conversation = 0;
+					FDialogueConversation LoadedConversation;
+					SerializePacked(Ar, Conversation);
+					Ar << LoadedConversation.Id;
+					SerializePacked(Ar, LoadedConversation.FirstLine);
+					SerializePacked(Ar, LoadedConversation.LineCount);
+
+					if (Ar.IsError() || Conversation >= MaxSavedConversations || LoadedConversation.Id.IsNone()
+						|| LoadedConversation.FirstLine > SeenLines.Num()
+						|| LoadedConversation.LineCount > SeenLines.Num() - LoadedConversation.FirstLine)
+					{
+						ULog::Error("DialogueSubsystem::ReadState", "Invalid conversation entry");
+						return false;
+					}
+
+					if (Conversations.Num() <= Conversation)
+					{
+						Conversations.SetNum(Conversation + 1);
+					}
+
+					ConversationLookup.Remove(Conversations[Conversation].Id);
+					LoadedConversation.Source = Conversations[Conversation].Source;
+					LoadedConversation.Dirty = false;
+					RegisterTelemetryId(LoadedConversation);
+					Conversations[Conversation] = LoadedConversation;
+					ConversationLookup.Add(LoadedConversation.Id, Conversation);
+				}
+			}
+			break;
+		case EDialogueSaveSection::Active:
+			{
+				uint8 HasConversation = 0;
+				Ar << HasConversation;
+				ActiveState = FDialogueActiveState();
+				ActiveWidget = nullptr;
+
+				if (HasConversation != 0)
+				{
+					FName ConversationId;
+					int RevealedCharacters = 0;
+					Ar << ConversationId;
+					SerializePacked(Ar, ActiveState.Line);
+					SerializePacked(Ar, RevealedCharacters);
+
+					ActiveState.Conversation = FindConversation(ConversationId);
+					ActiveState.TypingIndex = RevealedCharacters - 1;
+					if (Conversations.IsValidIndex(ActiveState.Conversation)
+						&& ActiveState.Line >= Conversations[ActiveState.Conversation].LineCount)
+					{
+						ULog::Error("DialogueSubsystem::ReadState", "Invalid active line");
+						return false;
+					}
+				}
+			}
+			break;
+		case EDialogueSaveSection::Variables:
+			{
+				int Count = 0;
+				SerializePacked(Ar, Count);
+
+				// An entry has at least the length of the name and the value
+				if (Ar.IsError() || !IsCountValid(Ar, Count, 8))
+				{
+					ULog::Error("DialogueSubsystem::ReadState", "Invalid variable section");
+					return false;
+				}
+
+				for (int Entry = 0; Entry < Count && !Ar.IsError(); Entry++)
+				{
+					FName Name;
+					int32 Value = 0;
+					Ar << Name << Value;
+					Variables.Add(Name, Value);
+				}
+			}
+			break;
+		case EDialogueSaveSection::SeenLines:
+			{
+				int Count = 0;
+				SerializePacked(Ar, Count);
+
+				// An entry has at least a packed word index and the word
+				if (Ar.IsError() || !IsCountValid(Ar, Count, 5))
+				{
+					ULog::Error("DialogueSubsystem::ReadState", "Invalid seen-line section");
+					return false;
+				}
+
+				for (int Entry = 0; Entry < Count && !Ar.IsError(); Entry++)
+				{
+					int WordIndex = 0;
+					uint32 Word = 0;
+					SerializePacked(Ar, WordIndex);
+					Ar << Word;
+
+					// The words are only written for lines of saved conversations, so the bitset is never grown here
+					if (WordIndex >= SeenLines.NumWords())
+					{
+						ULog::Error("DialogueSubsystem::ReadState", "Invalid seen-line word");
+						return false;
+					}
+
+					SeenLines.SetWord(WordIndex, Word);
+				}
+			}
+			break;
+		default:
+			ULog::Error("DialogueSubsystem::ReadState", FString("Unknown section = ").Append(FString::FromInt(Section)));
+			return false;
+		}
+	}
+
+	return !Ar.IsError();
+}
+
+/**
+ * @brief Forget all the changes after the state was saved or loaded
+ */
+void UDialogueSubsystem::ClearDirtyState()
+{
+	for (FDialogueConversation& Conversation : Conversations)
+	{
+		Conversation.Dirty = false;
+	}
+
+	DirtyVariables.Reset();
+	SeenLines.ClearDirtyWords();
+	ActiveStateDirty = false;
+}
\ No newline at end of file
@@ -0,0 +1,522 @@
+﻿#include "Core/DialogueTelemetry.h"
+#include "Core/Log.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+/**
+ * @brief The magic number at the start of every telemetry log ("UTDT")
+ */
+static constexpr uint32 DialogueTelemetryMagic = 0x54445455;
+
+/**
+ * @brief The version of the telemetry log
+ */
+static constexpr uint16 DialogueTelemetryVersion = 1;
+
+/**
+ * @brief The number of buffers allocated when the telemetry is started, so recording threads rarely allocate
+ */
+static constexpr int DialogueTelemetryInitialChunks = 4;
+
+/**
+ * @brief The blocks of the telemetry log
+ */
+enum class EDialogueTelemetryBlock : uint8
+{
+	Records = 1,
+	Names = 2
+};
+
+/**
+ * @brief A buffer of events owned by a single thread until it is published
+ */
+struct FDialogueTelemetryChunk
+{
+	/**
+	 * @brief The maximum number of events in a buffer
+	 */
+	static constexpr int Capacity = 1024;
+
+	/**
+	 * @brief The events in the buffer
+	 */
+	FDialogueTelemetryRecord Records[Capacity];
+
+	/**
+	 * @brief The number of events in the buffer
+	 */
+	int Num = 0;
+
+	/**
+	 * @brief The session the events were recorded in. Buffers of a stopped session are reused without writing them
+	 */
+	uint32 Session = 0;
+};
+
+/**
+ * @brief The buffer of the calling thread. Only accessed by the thread that owns it
+ */
+static thread_local FDialogueTelemetryChunk* ThreadChunk = nullptr;
+
+static FAutoConsoleCommand TelemetryStartCommand(
+	TEXT("UTDialogue.Telemetry.Start"),
+	TEXT("Start writing dialogue telemetry to a log file. Usage: UTDialogue.Telemetry.Start [Path]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FDialogueTelemetry::Get().Start(Args.Num() > 0 ? Args[0] : FString());
+	}));
+
+static FAutoConsoleCommand TelemetryStopCommand(
+	TEXT("UTDialogue.Telemetry.Stop"),
+	TEXT("Write the remaining dialogue telemetry and close the log file"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		FDialogueTelemetry::Get().Stop();
+	}));
+
+static FAutoConsoleCommand TelemetryBenchmarkCommand(
+	TEXT("UTDialogue.Telemetry.Benchmark"),
+	TEXT("Measure the time spent on the game thread to record a telemetry event. ")
+	TEXT("Usage: UTDialogue.Telemetry.Benchmark [Events]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FDialogueTelemetry::RunRecordBenchmark(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000000);
+	}));
+
+/**
+ * @brief Get the telemetry shared by the whole process
+ * @return The telemetry
+ */
+FDialogueTelemetry& FDialogueTelemetry::Get()
+{
+	static FDialogueTelemetry Telemetry;
+	return Telemetry;
+}
+
+/**
+ * @brief Release the buffers. The telemetry must be stopped before, usually when the module shuts down
+ */
+FDialogueTelemetry::~FDialogueTelemetry()
+{
+	// Joining a thread during static destruction is not safe, so a telemetry that is still running leaks its buffers
+	if (Thread != nullptr)
+	{
+		return;
+	}
+
+	TArray<FDialogueTelemetryChunk*> Chunks;
+	AllChunks.PopAll(Chunks);
+	for (const FDialogueTelemetryChunk* Chunk : Chunks)
+	{
+		delete Chunk;
+	}
+}
+
+/**
+ * @brief Start writing the recorded events to a new log file
+ * @param Path The path of the log file. A file in the Saved/Telemetry directory is used when empty
+ * @return A boolean value indicating if the telemetry was started
+ */
+bool FDialogueTelemetry::Start(const FString& Path)
+{
+	FScopeLock SessionLock(&SessionMutex);
+	FScopeLock Lock(&Mutex);
+	if (IsRunning())
+	{
+		ULog::Warning("DialogueTelemetry::Start", "Telemetry is already running");
+		return false;
+	}
+
+	LogPath = Path.IsEmpty()
+		? FPaths::ProjectSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("Dialogue-%s.utdt"),
+			*FDateTime::Now().ToString())
+		: Path;
+	Writer = IFileManager::Get().CreateFileWriter(*LogPath);
+	if (Writer == nullptr)
+	{
+		ULog::Error("DialogueTelemetry::Start", FString("Unable to create ").Append(LogPath));
+		LogPath.Empty();
+		return false;
+	}
+
+	uint32 Magic = DialogueTelemetryMagic;
+	uint16 Version = DialogueTelemetryVersion;
+	*Writer << Magic << Version;
+	WrittenNames = 0;
+
+	// Buffers published after the previous session was stopped are never written
+	TArray<FDialogueTelemetryChunk*> StaleChunks;
+	PublishedChunks.PopAll(StaleChunks);
+	for (FDialogueTelemetryChunk* Chunk : StaleChunks)
+	{
+		FreeChunks.Push(Chunk);
+	}
+
+	while (NumChunks.load() < DialogueTelemetryInitialChunks)
+	{
+		FreeChunks.Push(AllocateChunk());
+	}
+
+	StartCycles = FPlatformTime::Cycles64();
+	MillisecondsPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1000.0;
+	Session.fetch_add(1);
+	StopRequested = false;
+	Running = true;
+	Thread = FRunnableThread::Create(this, TEXT("DialogueTelemetryWriter"), 0, TPri_BelowNormal);
+
+	ULog::Info("DialogueTelemetry::Start", FString("Writing telemetry to ").Append(LogPath));
+	return true;
+}
+
+/**
+ * @brief Publish the events of the calling thread, write all the published events and close the log file
+ */
+void FDialogueTelemetry::Stop()
+{
+	FScopeLock SessionLock(&SessionMutex);
+	if (!IsRunning())
+	{
+		return;
+	}
+
+	FlushThread();
+	Running = false;
+
+	// A thread that saw the telemetry running might still publish a buffer, which must be written before the thread exits
+	while (ActiveRecorders.load() != 0)
+	{
+		FPlatformProcess::Yield();
+	}
+
+	StopRequested = true;
+	WakeEvent->Trigger();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+
+	FScopeLock Lock(&Mutex);
+	Writer->Close();
+	delete Writer;
+	Writer = nullptr;
+	ULog::Info("DialogueTelemetry::Stop", FString("Telemetry written to ").Append(LogPath));
+	LogPath.Empty();
+}
+
+/**
+ * @brief Get the path of the current log file
+ * @return The path of the log file or an empty string if the telemetry is not running
+ */
+FString FDialogueTelemetry::GetPath()
+{
+	FScopeLock Lock(&Mutex);
+	return LogPath;
+}
+
+/**
+ * @brief Record an event in the buffer of the calling thread. Does nothing when the telemetry is not running
+ * @param Event The type of the event
+ * @param Conversation The CRC of the stable ID of the conversation
+ * @param Line The index of the line
+ * @param Value The value of the event
+ */
+void FDialogueTelemetry::Record(const EDialogueTelemetryEvent Event, const uint32 Conversation, const int Line,
+	const uint32 Value)
+{
+	// Announce the thread before checking the state, so Stop either sees it or this thread sees the telemetry stopped
+	ActiveRecorders.fetch_add(1);
+	if (!Running.load())
+	{
+		ActiveRecorders.fetch_sub(1);
+		return;
+	}
+
+	FDialogueTelemetryChunk* Chunk = ThreadChunk;
+	const uint32 CurrentSession = Session.load(std::memory_order_relaxed);
+	if (Chunk == nullptr || Chunk->Session != CurrentSession)
+	{
+		Chunk = Chunk != nullptr ? Chunk : AcquireChunk();
+		Chunk->Num = 0;
+		Chunk->Session = CurrentSession;
+		ThreadChunk = Chunk;
+	}
+
+	FDialogueTelemetryRecord& NewRecord = Chunk->Records[Chunk->Num++];
+	NewRecord.Time = static_cast<uint32>((FPlatformTime::Cycles64() - StartCycles) * MillisecondsPerCycle);
+	NewRecord.Conversation = Conversation;
+	NewRecord.Line = static_cast<uint16>(FMath::Clamp(Line, 0, static_cast<int>(MAX_uint16)));
+	NewRecord.Event = Event;
+	NewRecord.Reserved = 0;
+	NewRecord.Value = Value;
+
+	if (Chunk->Num == FDialogueTelemetryChunk::Capacity)
+	{
+		ThreadChunk = nullptr;
+		PublishedChunks.Push(Chunk);
+		WakeEvent->Trigger();
+	}
+
+	ActiveRecorders.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Publish the buffer of the calling thread so the background thread writes it, even if it is not full
+ */
+void FDialogueTelemetry::FlushThread()
+{
+	FDialogueTelemetryChunk* Chunk = ThreadChunk;
+	if (Chunk == nullptr || Chunk->Num == 0)
+	{
+		return;
+	}
+
+	ActiveRecorders.fetch_add(1);
+	if (Running.load() && Chunk->Session == Session.load())
+	{
+		ThreadChunk = nullptr;
+		PublishedChunks.Push(Chunk);
+		WakeEvent->Trigger();
+	}
+
+	ActiveRecorders.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Store the name of a conversation so the log can be converted without the game data
+ * @param Conversation The CRC of the stable ID of the conversation
+ * @param Name The stable ID of the conversation
+ */
+void FDialogueTelemetry::RegisterName(const uint32 Conversation, const FString& Name)
+{
+	FScopeLock Lock(&Mutex);
+	bool AlreadyRegistered;
+	NameIds.Add(Conversation, &AlreadyRegistered);
+	if (!AlreadyRegistered)
+	{
+		Names.Emplace(Conversation, Name);
+	}
+}
+
+/**
+ * @brief Write the published buffers until the telemetry is stopped
+ * @return The exit code of the thread
+ */
+uint32 FDialogueTelemetry::Run()
+{
+	while (!StopRequested)
+	{
+		WakeEvent->Wait(1000);
+		WritePublishedChunks();
+	}
+
+	WritePublishedChunks();
+	return 0;
+}
+
+/**
+ * @brief Get a free buffer or allocate a new buffer
+ * @return The buffer
+ */
+FDialogueTelemetryChunk* FDialogueTelemetry::AcquireChunk()
+{
+	FDialogueTelemetryChunk* Chunk = FreeChunks.Pop();
+	return Chunk != nullptr ? Chunk : AllocateChunk();
+}
+
+/**
+ * @brief Allocate a new buffer and track it so it is released with the telemetry
+ * @return The buffer
+ */
+FDialogueTelemetryChunk* FDialogueTelemetry::AllocateChunk()
+{
+	FDialogueTelemetryChunk* Chunk = new FDialogueTelemetryChunk();
+	AllChunks.Push(Chunk);
+	NumChunks.fetch_add(1);
+	return Chunk;
+}
+
+/**
+ * @brief Write the new names and all the published buffers to the log file
+ */
+void FDialogueTelemetry::WritePublishedChunks()
+{
+	TArray<FDialogueTelemetryChunk*> Chunks;
+	PublishedChunks.PopAll(Chunks);
+
+	// The lock is only held to copy the new names, so RegisterName never waits for the log file. The writer is only
+	// used by this thread while the telemetry runs
+	TArray<TPair<uint32, FString>> NewNames;
+	{
+		FScopeLock Lock(&Mutex);
+		NewNames.Append(Names.GetData() + WrittenNames, Names.Num() - WrittenNames);
+		WrittenNames = Names.Num();
+	}
+
+	if (Writer != nullptr && NewNames.Num() > 0)
+	{
+		uint8 Block = static_cast<uint8>(EDialogueTelemetryBlock::Names);
+		uint32 Count = NewNames.Num();
+		*Writer << Block << Count;
+		for (TPair<uint32, FString>& Name : NewNames)
+		{
+			*Writer << Name.Key << Name.Value;
+		}
+	}
+
+	const uint32 CurrentSession = Session.load();
+	for (FDialogueTelemetryChunk* Chunk : Chunks)
+	{
+		if (Writer != nullptr && Chunk->Session == CurrentSession && Chunk->Num > 0)
+		{
+			uint8 Block = static_cast<uint8>(EDialogueTelemetryBlock::Records);
+			uint32 Count = Chunk->Num;
+			*Writer << Block << Count;
+			Writer->Serialize(Chunk->Records, Count * sizeof(FDialogueTelemetryRecord));
+		}
+
+		Chunk->Num = 0;
+		FreeChunks.Push(Chunk);
+	}
+
+	if (Writer != nullptr && Chunks.Num() > 0)
+	{
+		Writer->Flush();
+	}
+}
+
+/**
+ * @brief Read a telemetry log
+ * @param Path The path of the log file
+ * @param OutRecords The events in the log
+ * @param OutNames The names of the conversations in the log
+ * @return A boolean value indicating if the log was read without errors
+ */
+bool FDialogueTelemetry::ReadLog(const FString& Path, TArray<FDialogueTelemetryRecord>& OutRecords,
+	TMap<uint32, FString>& OutNames)
+{
+	const TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Path));
+	if (Reader == nullptr)
+	{
+		ULog::Error("DialogueTelemetry::ReadLog", FString("Unable to open ").Append(Path));
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	*Reader << Magic << Version;
+	if (Magic != DialogueTelemetryMagic || Version == 0 || Version > DialogueTelemetryVersion)
+	{
+		ULog::Error("DialogueTelemetry::ReadLog", FString("Not a supported telemetry log: ").Append(Path));
+		return false;
+	}
+
+	while (!Reader->AtEnd() && !Reader->IsError())
+	{
+		uint8 Block = 0;
+		uint32 Count = 0;
+		*Reader << Block << Count;
+		if (Block == static_cast<uint8>(EDialogueTelemetryBlock::Records))
+		{
+			if (Count > (Reader->TotalSize() - Reader->Tell()) / sizeof(FDialogueTelemetryRecord))
+			{
+				break;
+			}
+
+			const int First = OutRecords.AddUninitialized(Count);
+			Reader->Serialize(&OutRecords[First], Count * sizeof(FDialogueTelemetryRecord));
+		}
+		else if (Block == static_cast<uint8>(EDialogueTelemetryBlock::Names))
+		{
+			for (uint32 Name = 0; Name < Count && !Reader->IsError(); Name++)
+			{
+				uint32 Conversation = 0;
+				FString ConversationName;
+				*Reader << Conversation << ConversationName;
+				OutNames.Add(Conversation, ConversationName);
+			}
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	// A log that was not closed can end with a partial block
+	if (!Reader->AtEnd() || Reader->IsError())
+	{
+		ULog::Warning("DialogueTelemetry::ReadLog", FString("The log is truncated or corrupt: ").Append(Path));
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Get the name of an event
+ * @param Event The type of the event
+ * @return The name of the event
+ */
+const TCHAR* FDialogueTelemetry::GetEventName(const EDialogueTelemetryEvent Event)
+{
+	switch (Event)
+	{
+	case EDialogueTelemetryEvent::ConversationStarted:
+		return TEXT("ConversationStarted");
+	case EDialogueTelemetryEvent::ConversationEnded:
+		return TEXT("ConversationEnded");
+	case EDialogueTelemetryEvent::LineShown:
+		return TEXT("LineShown");
+	case EDialogueTelemetryEvent::LineSkipped:
+		return TEXT("LineSkipped");
+	case EDialogueTelemetryEvent::LineRevealed:
+		return TEXT("LineRevealed");
+	case EDialogueTelemetryEvent::LineExited:
+		return TEXT("LineExited");
+	case EDialogueTelemetryEvent::ChoiceSelected:
+		return TEXT("ChoiceSelected");
+	default:
+		return TEXT("Unknown");
+	}
+}
+
+/**
+ * @brief Measure the time spent on the calling thread to record an event and log the result
+ * @param NumEvents The number of events to record
+ */
+void FDialogueTelemetry::RunRecordBenchmark(const int NumEvents)
+{
+	FDialogueTelemetry& Telemetry = Get();
+	if (NumEvents <= 0 || Telemetry.IsRunning())
+	{
+		ULog::Error("DialogueTelemetry::RunRecordBenchmark", "Invalid event count or telemetry is already running");
+		return;
+	}
+
+	if (!Telemetry.Start(FPaths::ProjectSavedDir() / TEXT("Telemetry") / TEXT("Benchmark.utdt")))
+	{
+		return;
+	}
+
+	const uint64 BenchmarkStart = FPlatformTime::Cycles64();
+	for (int Event = 0; Event < NumEvents; Event++)
+	{
+		Telemetry.Record(EDialogueTelemetryEvent::LineShown, 0, Event & MAX_uint16, Event);
+	}
+
+	const double Nanoseconds = (FPlatformTime::Cycles64() - BenchmarkStart) * FPlatformTime::GetSecondsPerCycle64()
+		* 1000000000.0 / NumEvents;
+	Telemetry.Stop();
+
+	const FString Result = FString::Printf(TEXT("Events = %d: %.1f ns per event on the calling thread (budget 100 ns)"),
+		NumEvents, Nanoseconds);
+	if (Nanoseconds > 100.0)
+	{
+		ULog::Warning("DialogueTelemetry::RunRecordBenchmark", Result);
+	}
+	else
+	{
+		ULog::Info("DialogueTelemetry::RunRecordBenchmark", Result);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+﻿#include "UI/DialogueBacklogEntryWidget.h"
+#include "Components/TextBlock.h"
+#include "Core/DialogueSubsystem.h"
+#include "Core/Log.h"
+#include "UI/DialogueBacklogItem.h"
+
+/**
+ * @brief Called when the list view assigns an item to this entry widget
+ * @param ListItemObject The item assigned to this entry widget
+ */
+void UDialogueBacklogEntryWidget::NativeOnListItemObjectSet(UObject* ListItemObject)
+{
+	IUserObjectListEntry::NativeOnListItemObjectSet(ListItemObject);
+
+	const UDialogueBacklogItem* Item = Cast<UDialogueBacklogItem>(ListItemObject);
+	const UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (Item == nullptr || DialogueSubsystem == nullptr)
+	{
+		ULog::Error("DialogueBacklogEntryWidget::NativeOnListItemObjectSet", "Item or subsystem is nullptr");
+		return;
+	}
+
+	TitleText->SetText(DialogueSubsystem->GetLineTitle(Item->Entry.Conversation, Item->Entry.Line));
+	MessageText->SetText(DialogueSubsystem->GetLineMessage(Item->Entry.Conversation, Item->Entry.Line));
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+﻿#include "UI/DialogueBacklogWidget.h"
+#include "Components/ListView.h"
+#include "Core/DialogueSubsystem.h"
+#include "Internationalization/Internationalization.h"
+#include "Core/Log.h"
+
+/**
+ * @brief Overridable native event for when the widget has been constructed
+ */
+void UDialogueBacklogWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+	SetVisibility(ESlateVisibility::Collapsed);
+	FInternationalization::Get().OnCultureChanged().AddUObject(this, &UDialogueBacklogWidget::OnCultureChanged);
+}
+
+/**
+ * @brief Overridable native event for when the widget is being destroyed
+ */
+void UDialogueBacklogWidget::NativeDestruct()
+{
+	FInternationalization::Get().OnCultureChanged().RemoveAll(this);
+	Super::NativeDestruct();
+}
+
+/**
+ * @brief Show the backlog widget and scroll to the latest line
+ */
+void UDialogueBacklogWidget::ShowBacklog()
+{
+	ULog::Trace("DialogueBacklogWidget::ShowBacklog", "Showing backlog");
+	Refresh();
+	SetVisibility(ESlateVisibility::Visible);
+
+	if (VisibleItems.Num() > 0)
+	{
+		EntryList->ScrollIndexIntoView(VisibleItems.Num() - 1);
+	}
+}
+
+/**
+ * @brief Hide the backlog widget
+ */
+void UDialogueBacklogWidget::HideBacklog()
+{
+	ULog::Trace("DialogueBacklogWidget::HideBacklog", "Hiding backlog");
+	SetVisibility(ESlateVisibility::Collapsed);
+}
+
+/**
+ * @brief Update the list view using the current dialogue history
+ */
+void UDialogueBacklogWidget::Refresh()
+{
+	const UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (DialogueSubsystem == nullptr || EntryList == nullptr)
+	{
+		ULog::Error("DialogueBacklogWidget::Refresh", "DialogueSubsystem or EntryList is nullptr");
+		return;
+	}
+
+	const int HistoryNum = DialogueSubsystem->GetHistoryNum();
+	while (ItemPool.Num() < HistoryNum)
+	{
+		ItemPool.Add(NewObject<UDialogueBacklogItem>(this));
+	}
+
+	VisibleItems.Reset(HistoryNum);
+	for (int Index = 0; Index < HistoryNum; Index++)
+	{
+		ItemPool[Index]->Entry = DialogueSubsystem->GetHistoryEntry(Index);
+		VisibleItems.Add(ItemPool[Index]);
+	}
+
+	EntryList->SetListItems(VisibleItems);
+	EntryList->RegenerateAllEntries();
+}
+
+/**
+ * @brief Display the visible lines in the new culture
+ */
+void UDialogueBacklogWidget::OnCultureChanged()
+{
+	// The entries resolve their text when they are generated, so only a visible backlog needs to regenerate them
+	if (GetVisibility() != ESlateVisibility::Collapsed)
+	{
+		Refresh();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+﻿#include "UI/DialogueBarkWidget.h"
+#include "Components/TextBlock.h"
+#include "Core/Log.h"
+
+/**
+ * @brief Show the bark widget using the specified message
+ * @param Message The message to display
+ */
+void UDialogueBarkWidget::ShowBark(const FText& Message)
+{
+	if (BarkText == nullptr)
+	{
+		ULog::Error("DialogueBarkWidget::ShowBark", "BarkText is nullptr");
+		return;
+	}
+
+	BarkText->SetText(Message);
+	SetVisibility(ESlateVisibility::HitTestInvisible);
+}
+
+/**
+ * @brief Hide the bark widget
+ */
+void UDialogueBarkWidget::HideBark()
+{
+	SetVisibility(ESlateVisibility::Collapsed);
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+﻿#include "UI/DialogueChoiceEntryWidget.h"
+#include "Components/TextBlock.h"
+#include "Core/Log.h"
+#include "UI/DialogueChoiceItem.h"
+
+/**
+ * @brief Called when the list view assigns an item to this entry widget
+ * @param ListItemObject The item assigned to this entry widget
+ */
+void UDialogueChoiceEntryWidget::NativeOnListItemObjectSet(UObject* ListItemObject)
+{
+	IUserObjectListEntry::NativeOnListItemObjectSet(ListItemObject);
+
+	const UDialogueChoiceItem* Item = Cast<UDialogueChoiceItem>(ListItemObject);
+	if (Item == nullptr)
+	{
+		ULog::Error("DialogueChoiceEntryWidget::NativeOnListItemObjectSet", "Item is nullptr");
+		return;
+	}
+
+	ChoiceText->SetText(Item->Text);
+}
+
+/**
+ * @brief Display the text of the assigned item again after the item was reused for another choice
+ */
+void UDialogueChoiceEntryWidget::RefreshChoice()
+{
+	const UDialogueChoiceItem* Item = GetListItem<UDialogueChoiceItem>();
+	if (Item != nullptr)
+	{
+		ChoiceText->SetText(Item->Text);
+	}
+}
\ No newline at end of file
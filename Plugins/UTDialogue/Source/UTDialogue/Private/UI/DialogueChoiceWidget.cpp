@@ -0,0 +1,188 @@
+﻿#include "UI/DialogueChoiceWidget.h"
+#include "Components/ListView.h"
+#include "Core/DialogueManager.h"
+#include "UI/DialogueChoiceEntryWidget.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Core/Log.h"
+
+/**
+ * @brief Overridable native event for when the widget has been constructed
+ */
+void UDialogueChoiceWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+	SetVisibility(ESlateVisibility::Collapsed);
+
+	if (ChoiceList != nullptr)
+	{
+		ChoiceList->SetSelectionMode(ESelectionMode::Single);
+		ChoiceList->OnItemClicked().AddUObject(this, &UDialogueChoiceWidget::OnChoiceClicked);
+	}
+}
+
+/**
+ * @brief Overridable native event for when the widget is being destroyed
+ */
+void UDialogueChoiceWidget::NativeDestruct()
+{
+	if (ChoiceList != nullptr)
+	{
+		ChoiceList->OnItemClicked().RemoveAll(this);
+	}
+
+	Super::NativeDestruct();
+}
+
+/**
+ * @brief Show the choice menu, select the first choice and focus the list for keyboard and gamepad navigation
+ * @param Choices The choices to display
+ */
+void UDialogueChoiceWidget::ShowChoices(const TArray<FDialogueChoice>& Choices)
+{
+	if (ChoiceList == nullptr || Choices.Num() == 0)
+	{
+		ULog::Error("DialogueChoiceWidget::ShowChoices", "ChoiceList is nullptr or there are no choices");
+		return;
+	}
+
+	ULog::Trace("DialogueChoiceWidget::ShowChoices", "Showing choices");
+	while (ItemPool.Num() < Choices.Num())
+	{
+		ItemPool.Add(NewObject<UDialogueChoiceItem>(this));
+	}
+
+	for (int ChoiceIndex = 0; ChoiceIndex < Choices.Num(); ChoiceIndex++)
+	{
+		ItemPool[ChoiceIndex]->ChoiceIndex = ChoiceIndex;
+		ItemPool[ChoiceIndex]->Text = Choices[ChoiceIndex].Text;
+	}
+
+	// A menu with the same number of choices uses the same items, so the entry widgets only need the new text
+	if (VisibleItems.Num() == Choices.Num())
+	{
+		for (UUserWidget* Entry : ChoiceList->GetDisplayedEntryWidgets())
+		{
+			if (UDialogueChoiceEntryWidget* ChoiceEntry = Cast<UDialogueChoiceEntryWidget>(Entry))
+			{
+				ChoiceEntry->RefreshChoice();
+			}
+		}
+	}
+	else
+	{
+		VisibleItems.Reset(Choices.Num());
+		for (int ChoiceIndex = 0; ChoiceIndex < Choices.Num(); ChoiceIndex++)
+		{
+			VisibleItems.Add(ItemPool[ChoiceIndex]);
+		}
+
+		// The entry widgets are released to the pool of the list view and assigned to the reused items again
+		ChoiceList->SetListItems(VisibleItems);
+		ChoiceList->RegenerateAllEntries();
+	}
+
+	SetVisibility(ESlateVisibility::Visible);
+
+	ChoiceList->SetSelectedIndex(0);
+	ChoiceList->ScrollIndexIntoView(0);
+	ChoiceList->SetUserFocus(GetOwningPlayer());
+}
+
+/**
+ * @brief Hide the choice menu
+ */
+void UDialogueChoiceWidget::HideChoices()
+{
+	ULog::Trace("DialogueChoiceWidget::HideChoices", "Hiding choices");
+	SetVisibility(ESlateVisibility::Collapsed);
+	if (ChoiceList != nullptr)
+	{
+		ChoiceList->ClearSelection();
+	}
+}
+
+/**
+ * @brief Check if the choice menu is currently shown
+ * @return A boolean value indicating if the choice menu is currently shown
+ */
+bool UDialogueChoiceWidget::IsShowingChoices() const
+{
+	return GetVisibility() != ESlateVisibility::Collapsed && VisibleItems.Num() > 0;
+}
+
+/**
+ * @brief Move the selection by the specified number of choices. The selection wraps around
+ * @param Offset The number of choices to move. Negative values move up
+ */
+void UDialogueChoiceWidget::NavigateChoices(const int Offset)
+{
+	if (!IsShowingChoices())
+	{
+		return;
+	}
+
+	const int Num = VisibleItems.Num();
+	const int Selected = FMath::Max(GetSelectedChoice(), 0);
+	const int NewSelected = ((Selected + Offset) % Num + Num) % Num;
+	ChoiceList->SetSelectedIndex(NewSelected);
+	ChoiceList->NavigateToIndex(NewSelected);
+}
+
+/**
+ * @brief Get the index of the selected choice
+ * @return The index of the selected choice or -1 if no choice is selected
+ */
+int UDialogueChoiceWidget::GetSelectedChoice() const
+{
+	const UDialogueChoiceItem* Item = ChoiceList != nullptr
+		? Cast<UDialogueChoiceItem>(ChoiceList->GetSelectedItem())
+		: nullptr;
+	return Item != nullptr ? Item->ChoiceIndex : INDEX_NONE;
+}
+
+/**
+ * @brief Called when a key is pressed while the choice menu has focus. The accept key picks the selected choice
+ * @param InGeometry The geometry of the widget
+ * @param InKeyEvent The key event
+ * @return The reply indicating if the event was handled
+ */
+FReply UDialogueChoiceWidget::NativeOnKeyDown(const FGeometry& InGeometry, const FKeyEvent& InKeyEvent)
+{
+	if (IsShowingChoices()
+		&& FSlateApplication::Get().GetNavigationActionFromKey(InKeyEvent) == EUINavigationAction::Accept)
+	{
+		ConfirmChoice(GetSelectedChoice());
+		return FReply::Handled();
+	}
+
+	return Super::NativeOnKeyDown(InGeometry, InKeyEvent);
+}
+
+/**
+ * @brief Called when a choice is clicked
+ * @param Item The item of the clicked choice
+ */
+void UDialogueChoiceWidget::OnChoiceClicked(UObject* Item)
+{
+	const UDialogueChoiceItem* ChoiceItem = Cast<UDialogueChoiceItem>(Item);
+	if (ChoiceItem != nullptr)
+	{
+		ConfirmChoice(ChoiceItem->ChoiceIndex);
+	}
+}
+
+/**
+ * @brief Pick the specified choice using the dialogue manager
+ * @param ChoiceIndex The index of the choice
+ */
+void UDialogueChoiceWidget::ConfirmChoice(const int ChoiceIndex) const
+{
+	ADialogueManager* DialogueManager = ADialogueManager::Get(this);
+	if (DialogueManager == nullptr)
+	{
+		ULog::Error("DialogueChoiceWidget::ConfirmChoice", "DialogueManager is nullptr");
+		return;
+	}
+
+	DialogueManager->SelectDialogueChoice(ChoiceIndex);
+}
\ No newline at end of file
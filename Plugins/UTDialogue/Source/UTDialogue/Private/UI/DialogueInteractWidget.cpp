@@ -47,6 +47,15 @@ void UDialogueInteractWidget::HideWidget(const bool Animated)
 	PlayAnimation(HideAnimation);
 }
 
+/**
+ * @brief Check if the hide animation is playing
+ * @return A boolean value indicating if the hide animation is playing
+ */
+bool UDialogueInteractWidget::IsHiding() const
+{
+	return HideAnimation != nullptr && IsAnimationPlaying(HideAnimation);
+}
+
 /**
  * @brief Initialize the widget by setting the text and input indicator
  * @param Before The text that is displayed at the start of the widget
@@ -81,16 +90,21 @@ void UDialogueInteractWidget::InitializeInputIndicator(const TSubclassOf<UInputI
 		return;
 	}
 
+	if (InputIndicator != nullptr && InputIndicator->GetClass() == InputIndicatorClass)
+	{
+		ULog::Trace("DialogueInteractWidget::InitializeInputIndicator", "Reusing existing input indicator");
+		return;
+	}
+
 	if (InputIndicator != nullptr)
 	{
 		ULog::Trace("DialogueInteractWidget::InitializeInputIndicator", "Removing existing input indicator");
-		InputIndicator->RemoveFromViewport();
 		InputIndicator->RemoveFromParent();
 		InputIndicator = nullptr;
 	}
 
-	InputIndicator = CreateWidget<UInputIndicatorWidget>(GetWorld(), InputIndicatorClass);
-	InputIndicator->AddToViewport();
+	// The indicator is a child of the container, so it must not be added to the viewport as well
+	InputIndicator = CreateWidget<UInputIndicatorWidget>(this, InputIndicatorClass);
 	AfterText->RemoveFromParent();
 	Container->AddChild(InputIndicator);
     
@@ -1,10 +1,37 @@
 ﻿#include "UI/DialogueWidget.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/IsSorted.h"
+#include "Algo/StableSort.h"
+#include "Blueprint/WidgetBlueprintLibrary.h"
 #include "Components/AudioComponent.h"
+#include "Components/DialogueTrigger.h"
 #include "Components/TextBlock.h"
 #include "Core/DialogueManager.h"
+#include "Core/DialogueSubsystem.h"
+#include "Internationalization/Internationalization.h"
 #include "Kismet/GameplayStatics.h"
+#include "Quartz/AudioMixerClockHandle.h"
+#include "Quartz/QuartzSubsystem.h"
+#include "Sound/SoundWave.h"
+#include "UI/DialogueChoiceWidget.h"
 #include "Core/Log.h"
 
+/**
+ * @brief The tick rate of the clock used to schedule voice files. Voice files start on the audio render thread
+ * at the exact sample of the tick boundary
+ */
+static constexpr float VoiceClockTicksPerSecond = 1000.0f;
+
+/**
+ * @brief The maximum number of skip inputs waiting to be applied. The oldest input is dropped when the queue is full
+ */
+static constexpr int MaxQueuedInputs = 4;
+
+/**
+ * @brief The maximum number of stale lines rebuilt every frame in the background
+ */
+static constexpr int LineCacheRebuildsPerTick = 2;
+
 /**
  * @brief Overridable native event for when the widget has been constructed
  */
@@ -12,6 +39,24 @@ void UDialogueWidget::NativeConstruct()
 {
 	Super::NativeConstruct();
 	SetVisibility(ESlateVisibility::Collapsed);
+	VoiceSelector.Reset(VoiceSeed != 0 ? VoiceSeed : FMath::Rand());
+	FInternationalization::Get().OnCultureChanged().AddUObject(this, &UDialogueWidget::OnCultureChanged);
+}
+
+/**
+ * @brief Overridable native event for when the widget is being destroyed
+ */
+void UDialogueWidget::NativeDestruct()
+{
+	FInternationalization::Get().OnCultureChanged().RemoveAll(this);
+	UQuartzSubsystem* QuartzSubsystem = GetWorld() != nullptr ? GetWorld()->GetSubsystem<UQuartzSubsystem>() : nullptr;
+	if (VoiceClock != nullptr && QuartzSubsystem != nullptr)
+	{
+		QuartzSubsystem->DeleteClockByHandle(this, VoiceClock);
+		VoiceClock = nullptr;
+	}
+
+	Super::NativeDestruct();
 }
 
 /**
@@ -25,44 +70,130 @@ void UDialogueWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
 
 	if (UGameplayStatics::IsGamePaused(GetWorld()))
 	{
+		if (TypingMode == EDialogueTypingMode::VoiceDuration)
+		{
+			if (!VoicePaused)
+			{
+				ULog::Info("DialogueWidget::NativeTick", "Pausing audio");
+				CancelQueuedVoice();
+				if (AudioComponent != nullptr)
+				{
+					AudioComponent->SetPaused(true);
+				}
+			}
+
+			VoicePaused = true;
+			return;
+		}
+
 		if (IsAudioPlaying())
 		{
 			ULog::Info("DialogueWidget::NativeTick", "Stopping audio");
 			AudioComponent->Stop();
 		}
+
+		if (BlipAudioComponent != nullptr)
+		{
+			BlipAudioComponent->Stop();
+		}
 		
 		return;
 	}
+
+	// Recording keeps the real frame time and stores it, so the replay reveals the same characters on the same frame
+	float DeltaTime = InDeltaTime;
+	if (ReplayState == EDialogueReplayState::Recording)
+	{
+		Replay.FrameTimes.Add(InDeltaTime);
+	}
+	else if (ReplayState == EDialogueReplayState::Replaying)
+	{
+		DeltaTime = Replay.FrameTimes.IsValidIndex(ReplayFrame) ? Replay.FrameTimes[ReplayFrame++] : Replay.TimeStep;
+	}
+
+	if (ReplayState != EDialogueReplayState::None)
+	{
+		DialogueTime += DeltaTime;
+	}
+
+	BlipCooldown = FMath::Max(BlipCooldown - DeltaTime, 0.0f);
+
+	if (ReplayState == EDialogueReplayState::Replaying)
+	{
+		TickReplay();
+		if (GetVisibility() == ESlateVisibility::Collapsed)
+		{
+			return;
+		}
+	}
+
+	TickInput();
+	if (GetVisibility() == ESlateVisibility::Collapsed)
+	{
+		return;
+	}
+
+	TickLineCache();
+	if (WaitingForCultureLine)
+	{
+		TickCultureLine();
+	}
+
+	if (WaitingForLine)
+	{
+		TickLineProvider(DeltaTime);
+		return;
+	}
 	
+	const bool FastForwarding = IsFastForwarding();
+	if (TypingMode == EDialogueTypingMode::VoiceDuration && !FastForwarding)
+	{
+		TickVoiceTyping(DeltaTime);
+		return;
+	}
+
 	if (!BusyTyping)
 	{
+		TickAutoAdvance(DeltaTime);
 		return;
 	}
 
-	if (!IsAudioPlaying())
+	const int VoiceIndex = FastForwarding || IsAudioPlaying() ? INDEX_NONE : GetLineVoice(Index);
+	if (VoiceIndex != INDEX_NONE)
 	{
+#if UTDIALOGUE_VALIDATE_RUNTIME
 		ULog::Trace("DialogueWidget::NativeTick", "Playing audio");
-		AudioComponent = UGameplayStatics::CreateSound2D(GetWorld(), Voices[Index].GetDefaultObject()->GetRandomVoice());
-		AudioComponent->Play();
+#endif
+		UAudioComponent* Voice = GetOrCreateAudioComponent(AudioComponent);
+		Voice->SetSound(Voices[Index].GetDefaultObject()->Voices[VoiceIndex]);
+		Voice->Play();
 	}
 
-	TypingCounter += InDeltaTime;
-	if (TypingCounter <= 0.05f)
+	const float CharacterInterval = FastForwarding ? 1.0f / FastForwardCharactersPerSecond : TypingInterval;
+	TypingCounter += DeltaTime;
+	if (TypingCounter <= CharacterInterval)
 	{
 		return;
 	}
 
-	TypingIndex++;
-	TypingCounter = 0;
+	const int RevealedCharacters = FastForwarding ? FMath::FloorToInt(TypingCounter / CharacterInterval) : 1;
+	TypingIndex += RevealedCharacters;
+	TypingCounter = FastForwarding ? TypingCounter - RevealedCharacters * CharacterInterval : 0;
+
+	const FString& CurrentMessage = GetLineMessage(Index);
+	if (!FastForwarding)
+	{
+		PlayBlips(CurrentMessage, TypingIndex - RevealedCharacters);
+	}
 
-	const FString CurrentMessage = Messages[Index].ToString();
 	if (TypingIndex >= CurrentMessage.Len())
 	{
 		StopTyping();
 		return;
 	}
 
-	MessageText->SetText(FText::FromString(CurrentMessage.Left(TypingIndex)));
+	FireCues(TypingIndex);
+	SetMessageText(FText::FromString(CurrentMessage.Left(TypingIndex)));
 }
 
 /**
@@ -71,9 +202,23 @@ void UDialogueWidget::NativeTick(const FGeometry& MyGeometry, float InDeltaTime)
  * @param NewMessages The array of messages to display
  * @param NewVoices The array of voice files to play
  */
-void UDialogueWidget::Show(const TArray<FText> NewTitles, const TArray<FText> NewMessages,
-	const TArray<TSubclassOf<UDialogueVoiceList>> NewVoices)
+void UDialogueWidget::Show(const TArray<FText>& NewTitles, const TArray<FText>& NewMessages,
+	const TArray<TSubclassOf<UDialogueVoiceList>>& NewVoices)
+{
+	ShowConversation(INDEX_NONE, NewTitles, NewMessages, NewVoices);
+}
+
+/**
+ * @brief Show the Dialogue Widget for a registered conversation. The lines are added to the dialogue history
+ * @param NewConversation The handle of the conversation in the dialogue subsystem
+ * @param NewTitles The array of titles to display
+ * @param NewMessages The array of messages to display
+ * @param NewVoices The array of voice files to play
+ */
+void UDialogueWidget::ShowConversation(const int NewConversation, const TArray<FText>& NewTitles,
+	const TArray<FText>& NewMessages, const TArray<TSubclassOf<UDialogueVoiceList>>& NewVoices)
 {
+#if UTDIALOGUE_VALIDATE_RUNTIME
 	if (NewTitles.Num() != NewMessages.Num() || NewTitles.Num() != NewVoices.Num())
 	{
 		ULog::Error("DialogueWidget::Show", "Invalid dialogue data provided");
@@ -81,83 +226,1587 @@ void UDialogueWidget::Show(const TArray<FText> NewTitles, const TArray<FText> Ne
 	}
 
 	ULog::Info("DialogueWidget::Show", "Showing dialogue");
-	
-	Titles = NewTitles;
-	Messages = NewMessages;
+#endif
+
+	ShowPrepared(NewConversation, PrepareNow(NewConversation, NewTitles, NewMessages), NewVoices);
+}
+
+/**
+ * @brief Show the Dialogue Widget for a conversation that was prepared ahead of time. The prepared text is shared
+ * and not processed again, so the cost does not depend on the number of lines
+ * @param NewConversation The handle of the conversation in the dialogue subsystem
+ * @param NewPrepared The prepared text of the conversation
+ * @param NewVoices The array of voice files to play
+ */
+void UDialogueWidget::ShowPrepared(const int NewConversation,
+	const TSharedRef<const FDialoguePreparedConversation, ESPMode::ThreadSafe>& NewPrepared,
+	const TArray<TSubclassOf<UDialogueVoiceList>>& NewVoices)
+{
+	if (NewPrepared->Num() == 0 || NewPrepared->Num() != NewPrepared->GetMessages().Num()
+		|| NewPrepared->Num() != NewVoices.Num())
+	{
+		ULog::Error("DialogueWidget::ShowPrepared", "Invalid dialogue data provided");
+		return;
+	}
+
+	Conversation = NewConversation;
+	Prepared = NewPrepared;
 	Voices = NewVoices;
+	LineVoices.Init(INDEX_NONE, Voices.Num());
+	ResetInput();
+	ResolveLineSource();
+
+	const UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	TelemetryConversation = DialogueSubsystem != nullptr ? DialogueSubsystem->GetTelemetryId(Conversation) : 0;
+	LineStartTime = 0.0;
+	Index = 0;
+	ResetLineCache();
+	SyncReplayConversation();
+	RecordTelemetry(EDialogueTelemetryEvent::ConversationStarted);
 	UpdateIndex(0);
 	SetVisibility(ESlateVisibility::Visible);
 	UGameplayStatics::PlaySound2D(GetWorld(), InteractSound);
 }
 
+/**
+ * @brief Restore a conversation after loading a save. No sounds are played and the line is not added to the history
+ * @param NewConversation The handle of the conversation in the dialogue subsystem
+ * @param NewPrepared The prepared text of the conversation
+ * @param NewVoices The array of voice files to play
+ * @param Line The index of the line to display
+ * @param RevealedCharacters The number of characters already revealed or -1 if the line was fully revealed
+ * @return A boolean value indicating if the conversation was restored
+ */
+bool UDialogueWidget::RestoreConversation(const int NewConversation,
+	const TSharedRef<const FDialoguePreparedConversation, ESPMode::ThreadSafe>& NewPrepared,
+	const TArray<TSubclassOf<UDialogueVoiceList>>& NewVoices, const int Line, const int RevealedCharacters)
+{
+	if (Line < 0 || Line >= NewPrepared->Num() || NewPrepared->Num() != NewPrepared->GetMessages().Num()
+		|| NewPrepared->Num() != NewVoices.Num())
+	{
+		ULog::Error("DialogueWidget::RestoreConversation", "Invalid dialogue data provided");
+		return false;
+	}
+
+	ULog::Info("DialogueWidget::RestoreConversation", FString("Line = ").Append(FString::FromInt(Line)));
+
+	Conversation = NewConversation;
+	Prepared = NewPrepared;
+	Voices = NewVoices;
+	LineVoices.Init(INDEX_NONE, Voices.Num());
+	ResetInput();
+	Index = Line;
+	TypingCounter = 0;
+	LineStartTime = FPlatformTime::Seconds();
+	ResetLineCache();
+	TitleText->SetText(GetPrepared().GetTitles()[Index]);
+
+	// A restored line never waits. The provided message is only used when it is already cached
+	ResolveLineSource();
+	ApplyProvidedLine();
+	WaitingForLine = false;
+
+	const FString& CurrentMessage = GetLineMessage(Index);
+	BusyTyping = RevealedCharacters >= 0 && RevealedCharacters < CurrentMessage.Len();
+	TypingIndex = BusyTyping ? RevealedCharacters : 0;
+	SetMessageText(BusyTyping ? FText::FromString(CurrentMessage.Left(TypingIndex)) : GetMessage(Index));
+
+	// The cues before the restored position already fired before the save
+	const TArray<FDialogueCueTrack>& Cues = GetPrepared().GetCues();
+	const int MessageLength = CurrentMessage.Len();
+	ResetCueOrder();
+	SortCueOrder(MessageLength);
+	CueCursor = Cues.IsValidIndex(Index)
+		? Algo::UpperBoundBy(CueOrder, BusyTyping ? TypingIndex : MAX_int32,
+			[&Track = Cues[Index].Cues, MessageLength](const int Cue)
+			{
+				return Track[Cue].GetCharacterOffset(MessageLength);
+			})
+		: 0;
+	AdvanceCounter = 0;
+	CurrentLineSeen = WasLineSeen(Index);
+
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	TelemetryConversation = DialogueSubsystem != nullptr ? DialogueSubsystem->GetTelemetryId(Conversation) : 0;
+	if (Conversation != INDEX_NONE && DialogueSubsystem != nullptr)
+	{
+		DialogueSubsystem->SetActiveLine(this, Conversation, Index);
+	}
+
+	if (TypingMode == EDialogueTypingMode::VoiceDuration && !IsFastForwarding())
+	{
+		StartVoiceLine(BusyTyping ? TypingIndex : INDEX_NONE);
+	}
+
+	SetVisibility(ESlateVisibility::Visible);
+	if (!BusyTyping)
+	{
+		ShowLineChoices();
+	}
+
+	return true;
+}
+
+/**
+ * @brief Get the number of characters revealed by the typing animation
+ * @return The number of characters revealed or -1 if the current line is fully revealed
+ */
+int UDialogueWidget::GetRevealedCharacters() const
+{
+	return BusyTyping ? TypingIndex : INDEX_NONE;
+}
+
+/**
+ * @brief Get the number of characters of the current line that are visible
+ * @return The number of visible characters. The length of the message when the line is fully revealed
+ */
+int UDialogueWidget::GetTypingIndex() const
+{
+	if (BusyTyping || !GetPrepared().GetMessages().IsValidIndex(Index))
+	{
+		return BusyTyping ? TypingIndex : 0;
+	}
+
+	const FString* CurrentMessage = FindLineMessage(Index);
+	return CurrentMessage != nullptr ? CurrentMessage->Len() : GetMessage(Index).ToString().Len();
+}
+
 /**
  * @brief Skip the type animation or continue to the next message in the list
  * @return A boolean value indicating if the last message was skipped
  */
 bool UDialogueWidget::SkipMessage()
 {
-	ULog::Trace("DialogueWidget::SkipMessage", "Skipping message");
-	UGameplayStatics::PlaySound2D(GetWorld(), InteractSound);
-	
-	if (BusyTyping)
+	if (ReplayState == EDialogueReplayState::Replaying)
 	{
-		StopTyping();
+		ULog::Trace("DialogueWidget::SkipMessage", "Ignoring input while replaying");
 		return false;
 	}
 
-	if (Index + 1 >= Titles.Num())
+	// The input was received at the latest when the frame started, so the game thread time before this call is measured
+	const double Now = GetInputTime();
+	if (Now - LastInputTime < InputDebounceTime)
 	{
-		ADialogueManager* DialogueManager = dynamic_cast<ADialogueManager*>(
-			UGameplayStatics::GetActorOfClass(GetWorld(), ADialogueManager::StaticClass()));
-		if (DialogueManager == nullptr)
-		{
-			ULog::Error("DialogueTrigger::OnActorBeginOverlap", "DialogueManager is nullptr");
-		}
-		else
+		ULog::Trace("DialogueWidget::SkipMessage", "Ignoring repeated input");
+		return false;
+	}
+
+	LastInputTime = Now;
+	if (QueuedInputs.Num() == 0 && CanApplyInput())
+	{
+		return ApplyInput(Now);
+	}
+
+	ULog::Trace("DialogueWidget::SkipMessage", "Buffering input");
+	if (QueuedInputs.Num() >= MaxQueuedInputs)
+	{
+		QueuedInputs.RemoveAt(0, 1, false);
+	}
+
+	QueuedInputs.Add(Now);
+	return false;
+}
+
+/**
+ * @brief Pick a choice of the current line and continue to the next line of the choice
+ * @param ChoiceIndex The index of the choice
+ * @return A boolean value indicating if the choice ended the conversation
+ */
+bool UDialogueWidget::SelectChoice(const int ChoiceIndex)
+{
+	if (!IsShowingChoices() || !GetPrepared().GetChoices()[Index].Choices.IsValidIndex(ChoiceIndex))
+	{
+		ULog::Warning("DialogueWidget::SelectChoice", "No choice menu is shown or the choice is invalid");
+		return false;
+	}
+
+	const FDialogueChoice& Choice = GetPrepared().GetChoices()[Index].Choices[ChoiceIndex];
+	ULog::Info("DialogueWidget::SelectChoice", FString("ChoiceIndex = ").Append(FString::FromInt(ChoiceIndex)));
+	ChoiceWidget->HideChoices();
+	RecordTelemetry(EDialogueTelemetryEvent::ChoiceSelected, ChoiceIndex);
+
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (!Choice.VariableName.IsNone() && DialogueSubsystem != nullptr)
+	{
+		DialogueSubsystem->SetDialogueVariable(Choice.VariableName, Choice.VariableValue);
+	}
+
+	if (!GetPrepared().GetTitles().IsValidIndex(Choice.NextLine))
+	{
+		Dismiss();
+		return true;
+	}
+
+	UpdateIndex(Choice.NextLine);
+	return false;
+}
+
+/**
+ * @brief Move the selection in the choice menu by the specified number of choices
+ * @param Offset The number of choices to move. Negative values move up
+ */
+void UDialogueWidget::NavigateChoices(const int Offset)
+{
+	if (IsShowingChoices())
+	{
+		ChoiceWidget->NavigateChoices(Offset);
+	}
+}
+
+/**
+ * @brief Check if the choice menu of the current line is shown
+ * @return A boolean value indicating if the choice menu is shown
+ */
+bool UDialogueWidget::IsShowingChoices() const
+{
+	return ChoiceWidget != nullptr && GetPrepared().GetChoices().IsValidIndex(Index)
+		&& ChoiceWidget->IsShowingChoices();
+}
+
+/**
+ * @brief Change the seed used to select voice files. The selection history is cleared
+ * @param Seed The new seed. 0 uses a different seed every time
+ */
+void UDialogueWidget::SetVoiceSeed(const int Seed)
+{
+	VoiceSeed = Seed;
+	VoiceSelector.Reset(Seed != 0 ? Seed : FMath::Rand());
+	LineVoices.Init(INDEX_NONE, Voices.Num());
+}
+
+/**
+ * @brief Start recording the skip inputs. The voice selection is reset so the recording can be replayed
+ */
+void UDialogueWidget::StartRecording()
+{
+	ULog::Info("DialogueWidget::StartRecording", "Recording input");
+	Replay = FDialogueReplay();
+	Replay.Seed = VoiceSeed != 0 ? VoiceSeed : FMath::Rand();
+	Replay.TimeStep = ReplayTimeStep;
+	VoiceSelector.Reset(Replay.Seed);
+	LineVoices.Init(INDEX_NONE, Voices.Num());
+	ReplaySeenLines.Reset();
+	DialogueTime = 0;
+	ReplayState = EDialogueReplayState::Recording;
+}
+
+/**
+ * @brief Stop recording the skip inputs
+ * @return The recorded input
+ */
+FDialogueReplay UDialogueWidget::StopRecording()
+{
+	if (ReplayState != EDialogueReplayState::Recording)
+	{
+		ULog::Warning("DialogueWidget::StopRecording", "Widget is not recording");
+		return FDialogueReplay();
+	}
+
+	ULog::Info("DialogueWidget::StopRecording", FString("Inputs = ").Append(FString::FromInt(Replay.SkipTimes.Num())));
+	ReplayState = EDialogueReplayState::None;
+	return Replay;
+}
+
+/**
+ * @brief Replay recorded input. Live skip inputs are ignored until the replay is stopped
+ * @param NewReplay The recorded input
+ */
+void UDialogueWidget::StartReplay(const FDialogueReplay& NewReplay)
+{
+	if (NewReplay.TimeStep <= 0.0f)
+	{
+		ULog::Error("DialogueWidget::StartReplay", "Invalid replay time step");
+		return;
+	}
+
+	ULog::Info("DialogueWidget::StartReplay", "Replaying input");
+	Replay = NewReplay;
+	VoiceSelector.Reset(Replay.Seed);
+	LineVoices.Init(INDEX_NONE, Voices.Num());
+	ReplayCursor = 0;
+	ReplayFrame = 0;
+	ReplaySeenLines.Reset();
+	DialogueTime = 0;
+	ReplayState = EDialogueReplayState::Replaying;
+}
+
+/**
+ * @brief Stop replaying recorded input
+ */
+void UDialogueWidget::StopReplay()
+{
+	if (ReplayState == EDialogueReplayState::Replaying)
+	{
+		ULog::Info("DialogueWidget::StopReplay", "Stopping replay");
+		ReplayState = EDialogueReplayState::None;
+	}
+}
+
+/**
+ * @brief Get the replay state of the widget
+ * @return The replay state of the widget
+ */
+EDialogueReplayState UDialogueWidget::GetReplayState() const
+{
+	return ReplayState;
+}
+
+/**
+ * @brief Apply the recorded skip inputs that happened before the current dialogue time
+ */
+void UDialogueWidget::TickReplay()
+{
+	while (Replay.SkipTimes.IsValidIndex(ReplayCursor) && Replay.SkipTimes[ReplayCursor] <= DialogueTime)
+	{
+		ReplayCursor++;
+		if (ApplySkip())
 		{
-			DialogueManager->OnDialogueDismissed();
+			break;
 		}
-		
-		ULog::Info("DialogueWidget::SkipMessage", "Hiding dialogue widget");
-		SetVisibility(ESlateVisibility::Collapsed);
-		
-		if (IsAudioPlaying())
+	}
+}
+
+/**
+ * @brief Record or apply the start of the first conversation of a recording, so a replay shows the conversation at
+ * the same dialogue time and with the same seen lines
+ */
+void UDialogueWidget::SyncReplayConversation()
+{
+	const UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	const UDialogueTrigger* Source = DialogueSubsystem != nullptr
+		? DialogueSubsystem->GetConversationSource(Conversation)
+		: nullptr;
+	const FName ConversationId = Source != nullptr ? Source->GetConversationId() : NAME_None;
+
+	if (ReplayState == EDialogueReplayState::Recording && Replay.ConversationStartTime < 0.0f)
+	{
+		Replay.ConversationId = ConversationId;
+		Replay.ConversationStartTime = DialogueTime;
+		Replay.SeenLines.SetNum(GetPrepared().Num());
+		for (int Line = 0; Line < Replay.SeenLines.Num(); Line++)
 		{
-			ULog::Info("DialogueWidget::SkipMessage", "Stopping audio");
-			AudioComponent->Stop();
-			AudioComponent = nullptr;
+			Replay.SeenLines[Line] = WasLineSeen(Line);
 		}
-		
-		return true;
+
+		return;
+	}
+
+	if (ReplayState != EDialogueReplayState::Replaying || ReplaySeenLines.Num() > 0
+		|| Replay.ConversationStartTime < 0.0f)
+	{
+		return;
+	}
+
+	if (ConversationId != Replay.ConversationId || GetPrepared().Num() != Replay.SeenLines.Num())
+	{
+		ULog::Warning("DialogueWidget::SyncReplayConversation", "The conversation does not match the recording");
+		return;
+	}
+
+	ReplayConversation = Conversation;
+	ReplaySeenLines = Replay.SeenLines;
+	DialogueTime = Replay.ConversationStartTime;
+
+	// The frames recorded before the conversation was shown are skipped with the dialogue time
+	float FrameTime = 0.0f;
+	ReplayFrame = 0;
+	while (Replay.FrameTimes.IsValidIndex(ReplayFrame) && FrameTime < Replay.ConversationStartTime)
+	{
+		FrameTime += Replay.FrameTimes[ReplayFrame++];
 	}
-	
-	UpdateIndex(Index + 1);
-	return false;
 }
 
 /**
- * @brief Update the character index in the typing animation
- * @param NewIndex The new character index
+ * @brief Get the voice file of the specified line. The voice file is selected once per line
+ * @param Line The index of the line
+ * @return The index of the voice file or -1 if the line has no voice files
  */
-void UDialogueWidget::UpdateIndex(const int NewIndex)
+int UDialogueWidget::GetLineVoice(const int Line)
 {
-	ULog::Info("DialogueWidget::UpdateIndex", FString("NewIndex = ").Append(FString::FromInt(NewIndex)));
-	Index = NewIndex;
-	TitleText->SetText(Titles[Index]);
-	MessageText->SetText(FText::GetEmpty());
-	BusyTyping = true;
+	if (!LineVoices.IsValidIndex(Line) || Voices[Line] == nullptr || Voices[Line].GetDefaultObject()->UsesBlips())
+	{
+		return INDEX_NONE;
+	}
+
+	if (LineVoices[Line] == INDEX_NONE)
+	{
+		LineVoices[Line] = VoiceSelector.SelectVoice(Voices[Line].GetDefaultObject());
+	}
+
+	return LineVoices[Line];
 }
 
 /**
- * @brief Stop the typing animation and display the full message
+ * @brief Forget the buffered skip inputs and ignore inputs within the debounce time after showing the widget
  */
-void UDialogueWidget::StopTyping()
+void UDialogueWidget::ResetInput()
+{
+	QueuedInputs.Reset();
+	LastInputTime = GetInputTime();
+	LastInputFrame = GFrameCounter;
+	InputBlockedTime = 0.0;
+	PendingInputTime = 0.0;
+	MessageChangePending = false;
+
+	if (!InteractWidget.IsValid())
+	{
+		TArray<UUserWidget*> InteractWidgets;
+		UWidgetBlueprintLibrary::GetAllWidgetsOfClass(GetWorld(), InteractWidgets,
+			UDialogueInteractWidget::StaticClass(), false);
+		InteractWidget = InteractWidgets.Num() > 0 ? Cast<UDialogueInteractWidget>(InteractWidgets[0]) : nullptr;
+	}
+}
+
+/**
+ * @brief Check if a skip input can be applied now. Only one input is applied per frame and no input is applied on
+ * the frame the widget is shown
+ * @return A boolean value indicating if a skip input can be applied
+ */
+bool UDialogueWidget::CanApplyInput() const
+{
+	return GetVisibility() != ESlateVisibility::Collapsed && LastInputFrame != GFrameCounter
+		&& !IsInteractWidgetHiding();
+}
+
+/**
+ * @brief Check if the interact widget plays its hide animation
+ * @return A boolean value indicating if the interact widget is hiding
+ */
+bool UDialogueWidget::IsInteractWidgetHiding() const
+{
+	const UDialogueInteractWidget* Interact = InteractWidget.Get();
+	return Interact != nullptr && Interact->IsHiding();
+}
+
+/**
+ * @brief Get the time of a skip input received in the current frame. The same clock is used to measure the input
+ * latency, so the time is not taken from the application time, which a fixed time step advances by the step
+ * @return The time in seconds when the current frame started
+ */
+double UDialogueWidget::GetInputTime() const
+{
+	const UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	return DialogueSubsystem != nullptr ? DialogueSubsystem->GetFrameStartTime() : FPlatformTime::Seconds();
+}
+
+/**
+ * @brief Apply a skip input and start measuring the time until the message changes
+ * @param InputTime The time when the input was received
+ * @return A boolean value indicating if the last message was skipped
+ */
+bool UDialogueWidget::ApplyInput(const double InputTime)
+{
+	LastInputFrame = GFrameCounter;
+	PendingInputTime = InputTime;
+	MessageChangePending = false;
+	if (ReplayState == EDialogueReplayState::Recording)
+	{
+		Replay.SkipTimes.Add(DialogueTime);
+	}
+
+	return ApplySkip();
+}
+
+/**
+ * @brief Drop the buffered skip inputs that are older than the buffer window and apply the oldest remaining input
+ */
+void UDialogueWidget::TickInput()
+{
+	if (QueuedInputs.Num() == 0)
+	{
+		return;
+	}
+
+	const double Now = GetInputTime();
+	if (IsInteractWidgetHiding())
+	{
+		InputBlockedTime = Now;
+		return;
+	}
+
+	while (QueuedInputs.Num() > 0 && Now - FMath::Max(QueuedInputs[0], InputBlockedTime) > InputBufferWindow)
+	{
+		ULog::Trace("DialogueWidget::TickInput", "Dropping expired input");
+		QueuedInputs.RemoveAt(0, 1, false);
+	}
+
+	if (QueuedInputs.Num() > 0 && CanApplyInput())
+	{
+		const double InputTime = QueuedInputs[0];
+		QueuedInputs.RemoveAt(0, 1, false);
+		ApplyInput(InputTime);
+	}
+}
+
+/**
+ * @brief Change the text of the message. The input latency is recorded when the change is painted
+ * @param Text The new text of the message
+ */
+void UDialogueWidget::SetMessageText(const FText& Text)
+{
+	MessageText->SetText(Text);
+	MessageChangePending = PendingInputTime > 0.0;
+}
+
+/**
+ * @brief Paint the widget and record the input latency when the message changed since the last paint
+ * @param Args The arguments of the paint pass
+ * @param AllottedGeometry The geometry of the widget
+ * @param MyCullingRect The culling rectangle of the widget
+ * @param OutDrawElements The list the draw elements are added to
+ * @param LayerId The first layer of the widget
+ * @param InWidgetStyle The style inherited from the parent widget
+ * @param bParentEnabled Boolean value indicating if the parent widget is enabled
+ * @return The last layer used by the widget
+ */
+int32 UDialogueWidget::NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+	const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, const int32 LayerId,
+	const FWidgetStyle& InWidgetStyle, const bool bParentEnabled) const
+{
+	const int32 MaxLayerId = Super::NativePaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId,
+		InWidgetStyle, bParentEnabled);
+	if (MessageChangePending)
+	{
+		RecordInputLatency();
+	}
+
+	return MaxLayerId;
+}
+
+/**
+ * @brief Record the time from the start of the frame of the last applied skip input until now
+ */
+void UDialogueWidget::RecordInputLatency() const
+{
+	MessageChangePending = false;
+	if (PendingInputTime <= 0.0)
+	{
+		return;
+	}
+
+	const float Milliseconds = static_cast<float>((FPlatformTime::Seconds() - PendingInputTime) * 1000.0);
+	PendingInputTime = 0.0;
+
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (DialogueSubsystem != nullptr)
+	{
+		DialogueSubsystem->RecordInputLatency(Milliseconds);
+	}
+}
+
+/**
+ * @brief Get the prepared text of the current conversation
+ * @return The prepared conversation or an empty conversation if no conversation was shown
+ */
+const FDialoguePreparedConversation& UDialogueWidget::GetPrepared() const
+{
+	return Prepared.IsValid() ? *Prepared : FDialoguePreparedConversation::GetEmpty();
+}
+
+/**
+ * @brief Prepare a conversation on the game thread. Used when the conversation was not prepared ahead of time
+ * @param NewConversation The handle of the conversation in the dialogue subsystem
+ * @param NewTitles The array of titles to display
+ * @param NewMessages The array of messages to display
+ * @return The prepared conversation
+ */
+TSharedRef<const FDialoguePreparedConversation, ESPMode::ThreadSafe> UDialogueWidget::PrepareNow(
+	const int NewConversation, const TArray<FText>& NewTitles, const TArray<FText>& NewMessages) const
+{
+	const UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	const UDialogueTrigger* Source = DialogueSubsystem != nullptr
+		? DialogueSubsystem->GetConversationSource(NewConversation)
+		: nullptr;
+
+	// The choices and cues are copied like the lines, so the conversation continues if the trigger streams out
+	FDialoguePreparationSource PreparationSource = Source != nullptr
+		? Source->MakePreparationSource()
+		: FDialoguePreparationSource();
+	PreparationSource.Culture = FInternationalization::Get().GetCurrentCulture()->GetName();
+	PreparationSource.Titles = NewTitles;
+	PreparationSource.Messages = NewMessages;
+	return FDialoguePreparedConversation::Prepare(MoveTemp(PreparationSource)).ToSharedRef();
+}
+
+/**
+ * @brief Get the message of a line. The message received from the line provider is used when available
+ * @param Line The index of the line
+ * @return The message of the line
+ */
+const FText& UDialogueWidget::GetMessage(const int Line) const
+{
+	const FText* ProvidedMessage = ProvidedMessages.Find(Line);
+	return ProvidedMessage != nullptr ? *ProvidedMessage : GetPrepared().GetMessages()[Line];
+}
+
+/**
+ * @brief Find the message of a line as a string without building it
+ * @param Line The index of the line
+ * @return The message of the line in the current culture or nullptr if the string must be built
+ */
+const FString* UDialogueWidget::FindLineMessage(const int Line) const
+{
+	if (LineCache.IsValidIndex(Line) && !LineCache[Line].Stale)
+	{
+		return &LineCache[Line].Message;
+	}
+
+	if (PreparedStringsCurrent && !ProvidedMessages.Contains(Line))
+	{
+		return &GetPrepared().GetMessageStrings()[Line];
+	}
+
+	return nullptr;
+}
+
+/**
+ * @brief Forget the derived data of the previous conversation. The prepared strings are used when they match the
+ * current culture
+ */
+void UDialogueWidget::ResetLineCache()
+{
+	LineCache.Reset();
+	StaleLines.Reset();
+	ProvidedMessages.Reset();
+	WaitingForCultureLine = false;
+	PreparedStringsCurrent = GetPrepared().GetCulture() == FInternationalization::Get().GetCurrentCulture()->GetName();
+
+	// The culture changed while the conversation was prepared
+	if (!PreparedStringsCurrent)
+	{
+		InvalidateLineCache();
+	}
+}
+
+/**
+ * @brief Mark the derived data of every line as stale and queue the lines to be rebuilt, starting at the current
+ * line
+ */
+void UDialogueWidget::InvalidateLineCache()
+{
+	PreparedStringsCurrent = false;
+	LineCache.SetNum(GetPrepared().Num());
+	for (FDialogueLineCache& Line : LineCache)
+	{
+		Line.Stale = true;
+	}
+
+	// The queue is consumed from the end, so the current line comes first and the previous lines come last
+	StaleLines.Reset(LineCache.Num());
+	for (int Offset = LineCache.Num() - 1; Offset >= 0; Offset--)
+	{
+		StaleLines.Add((FMath::Max(Index, 0) + Offset) % LineCache.Num());
+	}
+}
+
+/**
+ * @brief Get the message of a line as a string. The string is built if it can't be found
+ * @param Line The index of the line
+ * @return The message of the line in the current culture
+ */
+const FString& UDialogueWidget::GetLineMessage(const int Line)
+{
+	if (const FString* CachedMessage = FindLineMessage(Line))
+	{
+		return *CachedMessage;
+	}
+
+	if (LineCache.Num() <= Line)
+	{
+		LineCache.SetNum(GetPrepared().Num());
+	}
+
+	FDialogueLineCache& Cache = LineCache[Line];
+	Cache.Message = GetMessage(Line).ToString();
+	Cache.Stale = false;
+	return Cache.Message;
+}
+
+/**
+ * @brief Rebuild a few stale lines. Spreads the cost of a culture change over several frames
+ */
+void UDialogueWidget::TickLineCache()
+{
+	int Rebuilt = 0;
+	while (Rebuilt < LineCacheRebuildsPerTick && StaleLines.Num() > 0)
+	{
+		const int Line = StaleLines.Pop(false);
+		if (LineCache.IsValidIndex(Line) && LineCache[Line].Stale)
+		{
+			GetLineMessage(Line);
+			Rebuilt++;
+		}
+	}
+}
+
+/**
+ * @brief Rebuild the derived data and display the current line in the new culture
+ */
+void UDialogueWidget::OnCultureChanged()
+{
+	ULog::Info("DialogueWidget::OnCultureChanged",
+		FString("Culture = ").Append(FInternationalization::Get().GetCurrentCulture()->GetName()));
+	InvalidateLineCache();
+
+	// The provided messages are in the previous culture. Every line requests its message again when it is shown
+	ProvidedMessages.Reset();
+	WaitingForCultureLine = false;
+
+	// A line waiting for its line provider is displayed in the new culture when it starts
+	if (GetVisibility() != ESlateVisibility::Collapsed && GetPrepared().GetTitles().IsValidIndex(Index)
+		&& !WaitingForLine)
+	{
+		if (UDialogueTrigger* Source = LineSource.Get())
+		{
+			Source->PrefetchProvidedLines(Index);
+			WaitingForCultureLine = true;
+		}
+
+		RefreshCurrentLine();
+	}
+}
+
+/**
+ * @brief Display the current line again and keep the typing progress. Used after the culture changed
+ */
+void UDialogueWidget::RefreshCurrentLine()
+{
+	TitleText->SetText(GetPrepared().GetTitles()[Index]);
+	if (!BusyTyping)
+	{
+		SetMessageText(GetMessage(Index));
+	}
+	else
+	{
+		const FString& CurrentMessage = GetLineMessage(Index);
+		if (TypingMode == EDialogueTypingMode::VoiceDuration && RevealTimes.Num() > 0)
+		{
+			// The voice file keeps playing, so the new message is spread over the same word timings
+			BuildRevealTimes(CurrentMessage, LineDuration, LineWordTimings);
+			TypingIndex = Algo::UpperBound(RevealTimes, LineElapsed);
+		}
+
+		TypingIndex = FMath::Min(TypingIndex, CurrentMessage.Len());
+		SetMessageText(FText::FromString(CurrentMessage.Left(TypingIndex)));
+	}
+
+	if (IsShowingChoices())
+	{
+		ChoiceWidget->ShowChoices(GetPrepared().GetChoices()[Index].Choices);
+	}
+}
+
+/**
+ * @brief Fire the cues of the current line that were reached since the last call
+ * @param RevealedCharacters The number of revealed characters
+ */
+void UDialogueWidget::FireCues(const int RevealedCharacters)
+{
+	if (!GetPrepared().GetCues().IsValidIndex(Index))
+	{
+		return;
+	}
+
+	// Only the cues that fire are visited, and a hitch that reveals many characters fires them in one broadcast.
+	// Per mille offsets are resolved against the message in the current culture, so the cues are sorted again when
+	// a provided line or a culture change replaces the message
+	const TArray<FDialogueCue>& Track = GetPrepared().GetCues()[Index].Cues;
+	const int MessageLength = GetLineMessage(Index).Len();
+	if (MessageLength != CueOrderLength)
+	{
+		SortCueOrder(MessageLength);
+	}
+
+	FiredCues.Reset();
+	while (CueCursor < CueOrder.Num()
+		&& Track[CueOrder[CueCursor]].GetCharacterOffset(MessageLength) <= RevealedCharacters)
+	{
+		FiredCues.Add(Track[CueOrder[CueCursor++]]);
+	}
+
+	if (FiredCues.Num() > 0)
+	{
+		OnDialogueCues.Broadcast(Index, FiredCues);
+	}
+}
+
+/**
+ * @brief Reset the cue order of the current line. No cue of the line has fired yet
+ */
+void UDialogueWidget::ResetCueOrder()
+{
+	const TArray<FDialogueCueTrack>& Cues = GetPrepared().GetCues();
+	CueOrder.SetNum(Cues.IsValidIndex(Index) ? Cues[Index].Cues.Num() : 0);
+	for (int Cue = 0; Cue < CueOrder.Num(); Cue++)
+	{
+		CueOrder[Cue] = Cue;
+	}
+
+	CueCursor = 0;
+	CueOrderLength = INDEX_NONE;
+}
+
+/**
+ * @brief Sort the cues of the current line that did not fire yet for the length of the current message
+ * @param MessageLength The length of the current message
+ */
+void UDialogueWidget::SortCueOrder(const int MessageLength)
+{
+	CueOrderLength = MessageLength;
+	if (!GetPrepared().GetCues().IsValidIndex(Index))
+	{
+		return;
+	}
+
+	// The prepared tracks are already sorted unless they mix units and the message length changed
+	const TArray<FDialogueCue>& Track = GetPrepared().GetCues()[Index].Cues;
+	const auto CharacterOffset = [&Track, MessageLength](const int Cue)
+	{
+		return Track[Cue].GetCharacterOffset(MessageLength);
+	};
+
+	const TArrayView<int> Pending = MakeArrayView(CueOrder).RightChop(CueCursor);
+	if (!Algo::IsSortedBy(Pending, CharacterOffset))
+	{
+		Algo::StableSortBy(Pending, CharacterOffset);
+	}
+}
+
+/**
+ * @brief Record a telemetry event for the current line
+ * @param Event The type of the event
+ * @param Value The value of the event
+ */
+void UDialogueWidget::RecordTelemetry(const EDialogueTelemetryEvent Event, const uint32 Value) const
+{
+	FDialogueTelemetry::Get().Record(Event, TelemetryConversation, Index, Value);
+}
+
+/**
+ * @brief Get the time spent on the current line
+ * @return The time in milliseconds since the current line was shown
+ */
+uint32 UDialogueWidget::GetLineMilliseconds() const
+{
+	return LineStartTime > 0.0 ? static_cast<uint32>((FPlatformTime::Seconds() - LineStartTime) * 1000.0) : 0;
+}
+
+/**
+ * @brief Skip the type animation or continue to the next message in the list
+ * @return A boolean value indicating if the last message was skipped
+ */
+bool UDialogueWidget::ApplySkip()
+{
+	ULog::Trace("DialogueWidget::SkipMessage", "Skipping message");
+	WaitingForLine = false;
+	UGameplayStatics::PlaySound2D(GetWorld(), InteractSound);
+
+	if (IsShowingChoices())
+	{
+		return SelectChoice(ChoiceWidget->GetSelectedChoice());
+	}
+	
+	if (BusyTyping)
+	{
+		RecordTelemetry(EDialogueTelemetryEvent::LineSkipped, TypingIndex);
+		StopTyping();
+		return false;
+	}
+
+	return AdvanceMessage();
+}
+
+/**
+ * @brief Continue to the next message in the list or dismiss the widget after the last message
+ * @return A boolean value indicating if the last message was dismissed
+ */
+bool UDialogueWidget::AdvanceMessage()
+{
+	// Automatic advance waits for the player to pick a choice
+	if (IsShowingChoices() || ShowLineChoices())
+	{
+		return false;
+	}
+
+	if (Index + 1 >= GetPrepared().GetTitles().Num())
+	{
+		Dismiss();
+		return true;
+	}
+	
+	UpdateIndex(Index + 1);
+	return false;
+}
+
+/**
+ * @brief Show the choice menu if the current line has choices
+ * @return A boolean value indicating if the choice menu is shown
+ */
+bool UDialogueWidget::ShowLineChoices()
+{
+	const TArray<FDialogueChoiceSet>& Choices = GetPrepared().GetChoices();
+	if (!Choices.IsValidIndex(Index) || Choices[Index].Choices.Num() == 0)
+	{
+		return false;
+	}
+
+	if (ChoiceWidget == nullptr)
+	{
+		ULog::Warning("DialogueWidget::ShowLineChoices", "ChoiceWidget is nullptr. Continuing to the next line");
+		return false;
+	}
+
+	CancelQueuedVoice();
+	ChoiceWidget->ShowChoices(Choices[Index].Choices);
+	return true;
+}
+
+/**
+ * @brief Hide the widget and notify the dialogue manager after the conversation ended
+ */
+void UDialogueWidget::Dismiss()
+{
+	ADialogueManager* DialogueManager = ADialogueManager::Get(this);
+	if (DialogueManager == nullptr)
+	{
+		ULog::Error("DialogueWidget::Dismiss", "DialogueManager is nullptr");
+	}
+	else
+	{
+		DialogueManager->OnDialogueDismissed();
+	}
+	
+	ULog::Info("DialogueWidget::Dismiss", "Hiding dialogue widget");
+	SetVisibility(ESlateVisibility::Collapsed);
+
+	// Lines prefetched past the end of the conversation or behind another branch are never shown
+	if (UDialogueTrigger* Source = LineSource.Get())
+	{
+		Source->CancelProvidedLines();
+	}
+
+	// The message of a dismissed widget is never painted again, so the input is not measured
+	PendingInputTime = 0.0;
+	MessageChangePending = false;
+	QueuedInputs.Reset();
+	if (ChoiceWidget != nullptr)
+	{
+		ChoiceWidget->HideChoices();
+	}
+
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (DialogueSubsystem != nullptr)
+	{
+		DialogueSubsystem->ClearActiveLine();
+	}
+	
+	if (IsAudioPlaying())
+	{
+		ULog::Info("DialogueWidget::Dismiss", "Stopping audio");
+		AudioComponent->Stop();
+	}
+
+	if (BlipAudioComponent != nullptr)
+	{
+		BlipAudioComponent->Stop();
+	}
+
+	CancelQueuedVoice();
+
+	// The last buffer of the conversation is written without waiting for it to fill up
+	RecordTelemetry(EDialogueTelemetryEvent::LineExited, GetLineMilliseconds());
+	RecordTelemetry(EDialogueTelemetryEvent::ConversationEnded);
+	FDialogueTelemetry::Get().FlushThread();
+	LineStartTime = 0.0;
+}
+
+/**
+ * @brief Update the character index in the typing animation
+ * @param NewIndex The new character index
+ */
+void UDialogueWidget::UpdateIndex(const int NewIndex)
+{
+#if UTDIALOGUE_VALIDATE_RUNTIME
+	ULog::Info("DialogueWidget::UpdateIndex", FString("NewIndex = ").Append(FString::FromInt(NewIndex)));
+#endif
+	if (LineStartTime > 0.0)
+	{
+		RecordTelemetry(EDialogueTelemetryEvent::LineExited, GetLineMilliseconds());
+	}
+
+	Index = NewIndex;
+	LineStartTime = FPlatformTime::Seconds();
+	RecordTelemetry(EDialogueTelemetryEvent::LineShown);
+	TitleText->SetText(GetPrepared().GetTitles()[Index]);
+	SetMessageText(FText::GetEmpty());
+	BlipCharacters = 0;
+	if (ChoiceWidget != nullptr && ChoiceWidget->IsShowingChoices())
+	{
+		ChoiceWidget->HideChoices();
+	}
+
+	BusyTyping = true;
+	AdvanceCounter = 0;
+	ResetCueOrder();
+	CurrentLineSeen = WasLineSeen(Index);
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (Conversation != INDEX_NONE && DialogueSubsystem != nullptr)
+	{
+		DialogueSubsystem->AddToHistory(Conversation, Index);
+		DialogueSubsystem->SetActiveLine(this, Conversation, Index);
+	}
+
+	WaitingForCultureLine = false;
+	WaitingForLine = !ApplyProvidedLine();
+	LineWaitTime = 0;
+	if (!WaitingForLine)
+	{
+		StartLine();
+	}
+}
+
+/**
+ * @brief Start the voice file of the current line once the message of the line is known
+ */
+void UDialogueWidget::StartLine()
+{
+	FireCues(0);
+	if (TypingMode != EDialogueTypingMode::VoiceDuration)
+	{
+		return;
+	}
+
+	if (IsFastForwarding())
+	{
+		CancelQueuedVoice();
+		if (IsAudioPlaying())
+		{
+			AudioComponent->Stop();
+		}
+
+		return;
+	}
+
+	StartVoiceLine();
+}
+
+/**
+ * @brief Find the trigger of the current conversation to use its line provider
+ */
+void UDialogueWidget::ResolveLineSource()
+{
+	const UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	UDialogueTrigger* Source = DialogueSubsystem != nullptr
+		? DialogueSubsystem->GetConversationSource(Conversation)
+		: nullptr;
+	LineSource = Source != nullptr && Source->LineProvider != nullptr ? Source : nullptr;
+	WaitingForLine = false;
+}
+
+/**
+ * @brief Prefetch the next lines and replace the current message with the provided message if it is available
+ * @return A boolean value indicating if the current message is known
+ */
+bool UDialogueWidget::ApplyProvidedLine()
+{
+	UDialogueTrigger* Source = LineSource.Get();
+	if (Source == nullptr)
+	{
+		return true;
+	}
+
+	Source->PrefetchProvidedLines(Index);
+
+	FText ProvidedMessage;
+	if (!Source->TryGetProvidedLine(Index, ProvidedMessage))
+	{
+		return false;
+	}
+
+	if (!ProvidedMessage.IsEmpty())
+	{
+		ProvidedMessages.Add(Index, ProvidedMessage);
+		if (LineCache.IsValidIndex(Index))
+		{
+			LineCache[Index].Stale = true;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Wait for the line provider without blocking and fall back to the static message after the timeout
+ * @param InDeltaTime The time since the last tick
+ */
+void UDialogueWidget::TickLineProvider(const float InDeltaTime)
+{
+	LineWaitTime += InDeltaTime;
+	if (!ApplyProvidedLine())
+	{
+		if (LineWaitTime < ProviderTimeout)
+		{
+			return;
+		}
+
+		ULog::Warning("DialogueWidget::TickLineProvider", "Line provider timed out. Using the static message");
+	}
+
+	WaitingForLine = false;
+	StartLine();
+}
+
+/**
+ * @brief Display the message the line provider returned in the new culture once it is available
+ */
+void UDialogueWidget::TickCultureLine()
+{
+	UDialogueTrigger* Source = LineSource.Get();
+	FText ProvidedMessage;
+	if (Source != nullptr && !Source->TryGetProvidedLine(Index, ProvidedMessage))
+	{
+		return;
+	}
+
+	WaitingForCultureLine = false;
+	if (ProvidedMessage.IsEmpty())
+	{
+		return;
+	}
+
+	ProvidedMessages.Add(Index, ProvidedMessage);
+	if (LineCache.IsValidIndex(Index))
+	{
+		LineCache[Index].Stale = true;
+	}
+
+	RefreshCurrentLine();
+}
+
+/**
+ * @brief Stop the typing animation and display the full message
+ */
+void UDialogueWidget::StopTyping()
 {
 	ULog::Trace("DialogueWidget::StopTyping", "Stopping to type");
 	BusyTyping = false;
 	TypingIndex = 0;
 	TypingCounter = 0;
-	MessageText->SetText(Messages[Index]);
+	AdvanceCounter = 0;
+	SetMessageText(GetMessage(Index));
+	RecordTelemetry(EDialogueTelemetryEvent::LineRevealed, GetLineMilliseconds());
+
+	// Skipping the typing animation fires the remaining cues so the gameplay state matches a fully typed line
+	FireCues(MAX_int32);
+
+	UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	if (Conversation != INDEX_NONE && DialogueSubsystem != nullptr)
+	{
+		DialogueSubsystem->MarkLineSeen(Conversation, Index);
+	}
+
+	if (Conversation == ReplayConversation && ReplaySeenLines.IsValidIndex(Index))
+	{
+		ReplaySeenLines[Index] = true;
+	}
+}
+
+/**
+ * @brief Check if the current line is fast-forwarded
+ * @return A boolean value indicating if the current line is fast-forwarded
+ */
+bool UDialogueWidget::IsFastForwarding() const
+{
+	return SkipSeenLines && CurrentLineSeen;
+}
+
+/**
+ * @brief Check if a line of the current conversation was seen. Replays use the seen lines of the recording
+ * @param Line The index of the line
+ * @return A boolean value indicating if the line was seen
+ */
+bool UDialogueWidget::WasLineSeen(const int Line) const
+{
+	if (ReplayState == EDialogueReplayState::Replaying && ReplaySeenLines.Num() > 0
+		&& Conversation == ReplayConversation)
+	{
+		return ReplaySeenLines.IsValidIndex(Line) && ReplaySeenLines[Line];
+	}
+
+	const UDialogueSubsystem* DialogueSubsystem = UDialogueSubsystem::Get(this);
+	return Conversation != INDEX_NONE && DialogueSubsystem != nullptr
+		&& DialogueSubsystem->IsLineSeen(Conversation, Line);
+}
+
+/**
+ * @brief Advance automatically when auto-advance or fast-forward is active and the delay has passed
+ * @param InDeltaTime The time since the last tick
+ */
+void UDialogueWidget::TickAutoAdvance(const float InDeltaTime)
+{
+	if (GetVisibility() == ESlateVisibility::Collapsed || (!AutoAdvance && !IsFastForwarding()))
+	{
+		return;
+	}
+
+	AdvanceCounter += InDeltaTime;
+	if (AdvanceCounter < (IsFastForwarding() ? FastForwardAdvanceDelay : AutoAdvanceDelay))
+	{
+		return;
+	}
+
+	ULog::Trace("DialogueWidget::TickAutoAdvance", "Advancing automatically");
+	AdvanceCounter = 0;
+	AdvanceMessage();
+}
+
+/**
+ * @brief Start the voice file of the current line and compute the reveal time of every character
+ * @param RevealedCharacters The number of characters already revealed or -1 if the line was fully revealed. The
+ * voice file starts at the time of the last revealed character
+ */
+void UDialogueWidget::StartVoiceLine(const int RevealedCharacters)
+{
+	const FString& CurrentMessage = GetLineMessage(Index);
+	const UDialogueVoiceList* VoiceList = Voices[Index] != nullptr ? Voices[Index].GetDefaultObject() : nullptr;
+
+	const int VoiceIndex = GetLineVoice(Index);
+	const USoundBase* Sound = VoiceIndex != INDEX_NONE ? VoiceList->Voices[VoiceIndex] : nullptr;
+	const float SoundDuration = Sound != nullptr ? Sound->GetDuration() : 0.0f;
+	const bool HasDuration = SoundDuration > 0.0f && SoundDuration < INDEFINITELY_LOOPING_DURATION;
+
+	VoicePaused = false;
+	VoicePlaybackTime = -1.0f;
+	LineDuration = HasDuration ? SoundDuration : CurrentMessage.Len() * TypingInterval;
+	LineWordTimings = HasDuration ? VoiceList->GetWordTimings(VoiceIndex) : nullptr;
+	BuildRevealTimes(CurrentMessage, LineDuration, LineWordTimings);
+
+	LineElapsed = 0.0f;
+	if (RevealedCharacters < 0)
+	{
+		LineElapsed = LineDuration;
+	}
+	else if (RevealedCharacters > 0 && RevealTimes.Num() > 0)
+	{
+		LineElapsed = RevealTimes[FMath::Min(RevealedCharacters, RevealTimes.Num()) - 1];
+	}
+
+	if (AdvancingFromVoice && QueuedLine == Index && QueuedAudioComponent != nullptr)
+	{
+		ULog::Trace("DialogueWidget::StartVoiceLine", "Using the queued voice file");
+		Swap(AudioComponent, QueuedAudioComponent);
+		QueuedLine = INDEX_NONE;
+	}
+	else
+	{
+		CancelQueuedVoice();
+		if (VoiceIndex != INDEX_NONE)
+		{
+			UAudioComponent* Voice = GetOrCreateVoiceComponent(AudioComponent);
+			Voice->Stop();
+			Voice->SetSound(VoiceList->Voices[VoiceIndex]);
+
+			// A fully revealed line has nothing left to say, so only the next voice file is queued
+			if (RevealedCharacters >= 0)
+			{
+				Voice->Play(LineElapsed);
+			}
+		}
+	}
+
+	QueueNextVoice();
+}
+
+/**
+ * @brief Schedule the voice file of the next line to start after the current voice file is finished
+ */
+void UDialogueWidget::QueueNextVoice()
+{
+	const int NextLine = Index + 1;
+	const TArray<FDialogueChoiceSet>& Choices = GetPrepared().GetChoices();
+	const bool HasChoices = Choices.IsValidIndex(Index) && Choices[Index].Choices.Num() > 0;
+	if (!VoiceAutoAdvance || HasChoices || !Voices.IsValidIndex(NextLine) || Voices[NextLine] == nullptr)
+	{
+		return;
+	}
+
+	const UDialogueVoiceList* NextVoiceList = Voices[NextLine].GetDefaultObject();
+	const int NextVoiceIndex = GetLineVoice(NextLine);
+	UQuartzSubsystem* QuartzSubsystem = GetWorld()->GetSubsystem<UQuartzSubsystem>();
+	if (NextVoiceIndex == INDEX_NONE || QuartzSubsystem == nullptr)
+	{
+		return;
+	}
+
+	if (VoiceClock == nullptr)
+	{
+		ULog::Trace("DialogueWidget::QueueNextVoice", "Creating voice clock");
+		// Clocks are shared by name across the world, so every widget uses its own clock
+		const FName ClockName(*FString::Printf(TEXT("DialogueVoiceClock_%u"), GetUniqueID()));
+		VoiceClock = QuartzSubsystem->CreateNewClock(this, ClockName, FQuartzClockSettings());
+		VoiceClock->SetTicksPerSecond(this, FQuartzQuantizationBoundary(), FOnQuartzCommandEventBP(), VoiceClock,
+			VoiceClockTicksPerSecond);
+		VoiceClock->StartClock(this, VoiceClock);
+	}
+
+	const float Delay = FMath::Max(LineDuration + VoiceLineGap - LineElapsed, 0.0f);
+	FQuartzQuantizationBoundary Boundary(EQuartzCommandQuantization::Tick,
+		FMath::Max(1.0f, FMath::RoundToFloat(Delay * VoiceClockTicksPerSecond)),
+		EQuarztQuantizationReference::CurrentTimeRelative);
+
+	UAudioComponent* QueuedVoice = GetOrCreateVoiceComponent(QueuedAudioComponent);
+	QueuedVoice->Stop();
+	QueuedVoice->SetSound(NextVoiceList->Voices[NextVoiceIndex]);
+	QueuedVoice->PlayQuantized(this, VoiceClock, Boundary, FOnQuartzCommandEventBP());
+
+	QueuedLine = NextLine;
+}
+
+/**
+ * @brief Stop the queued voice file before it starts playing
+ */
+void UDialogueWidget::CancelQueuedVoice()
+{
+	if (QueuedLine != INDEX_NONE && QueuedAudioComponent != nullptr)
+	{
+		QueuedAudioComponent->Stop();
+	}
+
+	QueuedLine = INDEX_NONE;
+}
+
+/**
+ * @brief Update the typing animation and automatic advance using the precomputed reveal times
+ * @param InDeltaTime The time since the last tick
+ */
+void UDialogueWidget::TickVoiceTyping(const float InDeltaTime)
+{
+	if (VoicePaused)
+	{
+		ULog::Info("DialogueWidget::TickVoiceTyping", "Resuming audio");
+		VoicePaused = false;
+		if (AudioComponent != nullptr)
+		{
+			AudioComponent->SetPaused(false);
+		}
+
+		QueueNextVoice();
+	}
+
+	// The game time only fills the gaps between the playback updates of the audio engine, so the reveal follows the
+	// voice file after hitches or a late start. Recordings and replays keep their fixed time step
+	LineElapsed += InDeltaTime;
+	if (VoicePlaybackTime >= 0.0f && ReplayState == EDialogueReplayState::None)
+	{
+		LineElapsed = VoicePlaybackTime;
+	}
+
+	VoicePlaybackTime = -1.0f;
+	if (BusyTyping)
+	{
+		const int PreviousTypingIndex = TypingIndex;
+		while (TypingIndex < RevealTimes.Num() && RevealTimes[TypingIndex] <= LineElapsed)
+		{
+			TypingIndex++;
+		}
+
+		if (TypingIndex != PreviousTypingIndex)
+		{
+			const FString& CurrentMessage = GetLineMessage(Index);
+			PlayBlips(CurrentMessage, PreviousTypingIndex);
+			FireCues(TypingIndex);
+			if (TypingIndex < RevealTimes.Num())
+			{
+				SetMessageText(FText::FromString(CurrentMessage.Left(TypingIndex)));
+			}
+		}
+
+		if (TypingIndex >= RevealTimes.Num())
+		{
+			StopTyping();
+		}
+
+		return;
+	}
+
+	if (!VoiceAutoAdvance)
+	{
+		TickAutoAdvance(InDeltaTime);
+		return;
+	}
+
+	if (GetVisibility() != ESlateVisibility::Collapsed && LineElapsed >= LineDuration + VoiceLineGap)
+	{
+		ULog::Trace("DialogueWidget::TickVoiceTyping", "Voice file finished. Advancing automatically");
+		AdvancingFromVoice = true;
+		AdvanceMessage();
+		AdvancingFromVoice = false;
+	}
+}
+
+/**
+ * @brief Play a blip for the revealed letters when the voice list of the current line uses blips. Every blip reuses
+ * the same audio component and only changes the pitch and volume
+ * @param Message The current message
+ * @param FirstCharacter The index of the first character revealed since the last call
+ */
+void UDialogueWidget::PlayBlips(const FString& Message, const int FirstCharacter)
+{
+	const UDialogueVoiceList* VoiceList = Voices[Index] != nullptr ? Voices[Index].GetDefaultObject() : nullptr;
+	if (VoiceList == nullptr || !VoiceList->UsesBlips())
+	{
+		return;
+	}
+
+	const FDialogueBlipProfile& Profile = VoiceList->BlipProfile;
+	int BlipCharacter = INDEX_NONE;
+	for (int Character = FMath::Max(FirstCharacter, 0); Character < FMath::Min(TypingIndex, Message.Len()); Character++)
+	{
+		if (!FChar::IsWhitespace(Message[Character]) && !FChar::IsPunct(Message[Character])
+			&& BlipCharacters++ % FMath::Max(Profile.CharactersPerBlip, 1) == 0)
+		{
+			BlipCharacter = Character;
+		}
+	}
+
+	if (BlipCharacter == INDEX_NONE || BlipCooldown > 0.0f)
+	{
+		return;
+	}
+
+	UAudioComponent* Blip = GetOrCreateAudioComponent(BlipAudioComponent);
+	if (Blip->Sound != Profile.Sound)
+	{
+		Blip->SetSound(Profile.Sound);
+	}
+
+	Blip->SetPitchMultiplier(VoiceSelector.SelectBlipPitch(Profile, Message[BlipCharacter]));
+	Blip->SetVolumeMultiplier(Profile.Volume);
+	Blip->Play();
+	BlipCooldown = Profile.MinInterval;
+}
+
+/**
+ * @brief Compute the time when every character in the current message is revealed
+ * @param Message The current message
+ * @param Duration The duration of the voice file
+ * @param WordStartTimes Optional timing markers for every word in the message
+ */
+void UDialogueWidget::BuildRevealTimes(const FString& Message, const float Duration,
+	const TArray<float>* WordStartTimes)
+{
+	const int Length = Message.Len();
+	RevealTimes.SetNumUninitialized(Length);
+
+	if (WordStartTimes == nullptr)
+	{
+		for (int Character = 0; Character < Length; Character++)
+		{
+			RevealTimes[Character] = Duration * (Character + 1) / Length;
+		}
+
+		return;
+	}
+
+	TArray<int> WordStarts;
+	for (int Character = 0; Character < Length; Character++)
+	{
+		if (!FChar::IsWhitespace(Message[Character]) && (Character == 0 || FChar::IsWhitespace(Message[Character - 1])))
+		{
+			WordStarts.Add(Character);
+		}
+	}
+
+	const int NumWords = WordStarts.Num();
+	const int NumMarkers = FMath::Min(WordStartTimes->Num(), NumWords);
+	auto GetWordStartTime = [&](const int Word)
+	{
+		if (Word >= NumWords)
+		{
+			return Duration;
+		}
+
+		if (Word < NumMarkers)
+		{
+			return FMath::Clamp((*WordStartTimes)[Word], 0.0f, Duration);
+		}
+
+		const float LastMarker = NumMarkers > 0 ? (*WordStartTimes)[NumMarkers - 1] : 0.0f;
+		return LastMarker + (Duration - LastMarker) * (Word - NumMarkers + 1) / (NumWords - NumMarkers + 1);
+	};
+
+	for (int Character = 0; Character < (NumWords > 0 ? WordStarts[0] : Length); Character++)
+	{
+		RevealTimes[Character] = 0.0f;
+	}
+
+	for (int Word = 0; Word < NumWords; Word++)
+	{
+		const int FirstCharacter = WordStarts[Word];
+		const int EndCharacter = Word + 1 < NumWords ? WordStarts[Word + 1] : Length;
+		const float StartTime = GetWordStartTime(Word);
+		const float EndTime = FMath::Max(StartTime, GetWordStartTime(Word + 1));
+
+		for (int Character = FirstCharacter; Character < EndCharacter; Character++)
+		{
+			const float Alpha = static_cast<float>(Character - FirstCharacter + 1) / (EndCharacter - FirstCharacter);
+			RevealTimes[Character] = FMath::Lerp(StartTime, EndTime, Alpha);
+		}
+	}
+}
+
+/**
+ * @brief Get an audio component that is reused for every voice file
+ * @param Component The audio component to create if needed
+ * @return The audio component
+ */
+UAudioComponent* UDialogueWidget::GetOrCreateAudioComponent(UAudioComponent*& Component)
+{
+	if (Component == nullptr)
+	{
+		ULog::Trace("DialogueWidget::GetOrCreateAudioComponent", "Creating audio component");
+		Component = NewObject<UAudioComponent>(this);
+		Component->bAutoDestroy = false;
+		Component->bIsUISound = true;
+		Component->bAllowSpatialization = false;
+		Component->RegisterComponentWithWorld(GetWorld());
+	}
+
+	return Component;
+}
+
+/**
+ * @brief Get an audio component that is reused for every voice file and reports its playback time
+ * @param Component The audio component to create if needed
+ * @return The audio component
+ */
+UAudioComponent* UDialogueWidget::GetOrCreateVoiceComponent(UAudioComponent*& Component)
+{
+	UAudioComponent* Voice = GetOrCreateAudioComponent(Component);
+	if (!Voice->OnAudioPlaybackPercentNative.IsBoundToObject(this))
+	{
+		Voice->OnAudioPlaybackPercentNative.AddUObject(this, &UDialogueWidget::OnVoicePlaybackPercent);
+	}
+
+	return Voice;
+}
+
+/**
+ * @brief Function called by the audio engine when the playback time of a voice file changed
+ * @param Component The audio component playing the voice file
+ * @param PlayingSoundWave The sound wave that is playing
+ * @param Percent The playback time as a fraction of the duration of the sound wave
+ */
+void UDialogueWidget::OnVoicePlaybackPercent(const UAudioComponent* Component, const USoundWave* PlayingSoundWave,
+	const float Percent)
+{
+	// The queued audio component reports its position before it becomes the current voice file
+	if (Component != AudioComponent || PlayingSoundWave == nullptr || VoicePaused)
+	{
+		return;
+	}
+
+	VoicePlaybackTime = Percent * PlayingSoundWave->GetDuration();
 }
 
 /**
@@ -1,4 +1,5 @@
 #include "UTDialogue.h"
+#include "Core/DialogueTelemetry.h"
 
 #define LOCTEXT_NAMESPACE "FUTDialogueModule"
 
@@ -8,6 +9,7 @@ void FUTDialogueModule::StartupModule()
 
 void FUTDialogueModule::ShutdownModule()
 {
+	FDialogueTelemetry::Get().Stop();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -4,6 +4,94 @@
 #include "Engine/DataAsset.h"
 #include "DialogueVoiceList.generated.h"
 
+/**
+ * @brief The strategy used to select a voice file from a voice list
+ */
+UENUM(BlueprintType)
+enum class EDialogueVoiceSelection : uint8
+{
+	Random UMETA(DisplayName = "Random"),
+	ShuffleBag UMETA(DisplayName = "Shuffle bag"),
+	Weighted UMETA(DisplayName = "Weighted"),
+	Sequential UMETA(DisplayName = "Sequential")
+};
+
+/**
+ * @brief The way a voice list voices a line
+ */
+UENUM(BlueprintType)
+enum class EDialogueVoiceMode : uint8
+{
+	VoiceFiles UMETA(DisplayName = "Voice files"),
+	Blips UMETA(DisplayName = "Blips")
+};
+
+/**
+ * @brief A speaker profile used to voice a line with short blips of a single sound while the text is typed
+ */
+USTRUCT(BlueprintType)
+struct FDialogueBlipProfile
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief The sound played for every blip
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NPC Voice")
+	USoundBase* Sound = nullptr;
+
+	/**
+	 * @brief The lowest pitch multiplier of a blip
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NPC Voice", meta = (ClampMin = "0.1"))
+	float MinPitch = 0.9f;
+
+	/**
+	 * @brief The highest pitch multiplier of a blip
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NPC Voice", meta = (ClampMin = "0.1"))
+	float MaxPitch = 1.1f;
+
+	/**
+	 * @brief The volume multiplier of every blip
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NPC Voice", meta = (ClampMin = "0.0"))
+	float Volume = 1.0f;
+
+	/**
+	 * @brief The number of revealed letters between two blips. Spaces and punctuation are not counted
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NPC Voice", meta = (ClampMin = "1"))
+	int CharactersPerBlip = 2;
+
+	/**
+	 * @brief The minimum time in seconds between two blips. Limits the blip rate when the text is typed quickly
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NPC Voice", meta = (ClampMin = "0.0"))
+	float MinInterval = 0.05f;
+
+	/**
+	 * @brief Derive the pitch from the revealed letter so the same word always sounds the same
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NPC Voice")
+	bool PitchFromCharacter = false;
+};
+
+/**
+ * @brief Optional timing markers for a voice file. Used to reveal the text word by word in sync with the audio
+ */
+USTRUCT(BlueprintType)
+struct FDialogueWordTimings
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief The time in seconds when every word starts in the voice file
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "NPC Voice")
+	TArray<float> WordStartTimes;
+};
+
 /**
  * @brief Contains an array of voice files that can be played when a dialogue is shown
  */
@@ -19,10 +107,72 @@ public:
 	UPROPERTY(EditAnywhere, Category = "NPC Voice")
 	TArray<USoundBase*> Voices;
 
+	/**
+	 * @brief The way the lines are voiced. Blips only load a single sound instead of every voice file
+	 */
+	UPROPERTY(EditAnywhere, Category = "NPC Voice")
+	EDialogueVoiceMode VoiceMode;
+
+	/**
+	 * @brief The speaker profile used when the lines are voiced with blips
+	 */
+	UPROPERTY(EditAnywhere, Category = "NPC Voice", meta = (EditCondition = "VoiceMode == EDialogueVoiceMode::Blips"))
+	FDialogueBlipProfile BlipProfile;
+
+	/**
+	 * @brief The strategy used to select a voice file. Shuffle bag plays every voice file once before repeating one
+	 */
+	UPROPERTY(EditAnywhere, Category = "NPC Voice")
+	EDialogueVoiceSelection SelectionMode;
+
+	/**
+	 * @brief The relative weight of every audio file when using weighted selection. Missing weights count as 1
+	 */
+	UPROPERTY(EditAnywhere, Category = "NPC Voice", meta = (ClampMin = "0.0"))
+	TArray<float> Weights;
+
+	/**
+	 * @brief Optional word timing markers for every audio file. The index matches the index in the array of voices
+	 */
+	UPROPERTY(EditAnywhere, Category = "NPC Voice")
+	TArray<FDialogueWordTimings> WordTimings;
+
 	/**
 	 * @brief Get a random audio file from the array of available audio files
-	 * @return A random audio file from the array of available audio files
+	 * @return A random audio file or nullptr if there are no audio files
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
-	USoundBase* GetRandomVoice();
+	USoundBase* GetRandomVoice() const;
+
+	/**
+	 * @brief Get the weight of the specified audio file when using weighted selection
+	 * @param VoiceIndex The index of the audio file
+	 * @return The weight of the audio file
+	 */
+	float GetWeight(int VoiceIndex) const;
+
+	/**
+	 * @brief Get the word timing markers of the specified audio file
+	 * @param VoiceIndex The index of the audio file
+	 * @return The word timing markers or nullptr if the audio file has no markers
+	 */
+	const TArray<float>* GetWordTimings(int VoiceIndex) const;
+
+	/**
+	 * @brief Check if the lines are voiced with blips
+	 * @return A boolean value indicating if the lines are voiced with blips
+	 */
+	bool UsesBlips() const
+	{
+		return VoiceMode == EDialogueVoiceMode::Blips && BlipProfile.Sound != nullptr;
+	}
+
+#if WITH_EDITOR
+	/**
+	 * @brief Validate the voice files. Used by the editor data validation and the dialogue validation commandlet
+	 * @param ValidationErrors The errors found while validating the data
+	 * @return The result of the validation
+	 */
+	virtual EDataValidationResult IsDataValid(TArray<FText>& ValidationErrors) override;
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,92 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+class UDialogueVoiceList;
+struct FDialogueBlipProfile;
+
+/**
+ * @brief Selects voice files from voice lists using a seeded random stream. Every speaker owns a selector so the same
+ * seed always produces the same voice files
+ */
+class UTDIALOGUE_API FDialogueVoiceSelector
+{
+public:
+	/**
+	 * @brief Create a selector
+	 * @param Seed The seed of the random stream
+	 */
+	explicit FDialogueVoiceSelector(int Seed = 0);
+
+	/**
+	 * @brief Change the seed of the random stream and forget the voice files that were selected
+	 * @param Seed The seed of the random stream
+	 */
+	void Reset(int Seed);
+
+	/**
+	 * @brief Get the seed of the random stream
+	 * @return The seed of the random stream
+	 */
+	int GetSeed() const
+	{
+		return Random.GetInitialSeed();
+	}
+
+	/**
+	 * @brief Select a voice file using the selection mode of the voice list
+	 * @param VoiceList The voice list to select from
+	 * @return The index of the selected voice file or -1 if the voice list has no voice files
+	 */
+	int SelectVoice(const UDialogueVoiceList* VoiceList);
+
+	/**
+	 * @brief Select the pitch of a blip using the random stream, so replays produce the same blips
+	 * @param Profile The speaker profile of the blip
+	 * @param Character The letter that is voiced by the blip
+	 * @return The pitch multiplier of the blip
+	 */
+	float SelectBlipPitch(const FDialogueBlipProfile& Profile, TCHAR Character);
+
+private:
+	/**
+	 * @brief The selection state of a single voice list
+	 */
+	struct FVoiceListState
+	{
+		/**
+		 * @brief The voice files that were not played yet in the current shuffle bag. Drawn from the end
+		 */
+		TArray<int> Bag;
+
+		/**
+		 * @brief The index of the last selected voice file
+		 */
+		int Last = INDEX_NONE;
+	};
+
+	/**
+	 * @brief The random stream used for every selection
+	 */
+	FRandomStream Random;
+
+	/**
+	 * @brief The selection state of every voice list used by the speaker
+	 */
+	TMap<const UDialogueVoiceList*, FVoiceListState> States;
+
+	/**
+	 * @brief Draw the next voice file from the shuffle bag. The bag is refilled when it is empty
+	 * @param State The selection state of the voice list
+	 * @param NumVoices The number of voice files in the voice list
+	 * @return The index of the selected voice file
+	 */
+	int DrawFromBag(FVoiceListState& State, int NumVoices);
+
+	/**
+	 * @brief Select a voice file using the weights of the voice list
+	 * @param VoiceList The voice list to select from
+	 * @return The index of the selected voice file
+	 */
+	int SelectWeighted(const UDialogueVoiceList* VoiceList);
+};
\ No newline at end of file
@@ -0,0 +1,134 @@
+﻿#pragma once
+
+#include "Audio/DialogueVoiceList.h"
+#include "Audio/DialogueVoiceSelector.h"
+#include "Components/ActorComponent.h"
+#include "DialogueBarkComponent.generated.h"
+
+/**
+ * @brief Contains the ambient lines an NPC can say. Barks are scheduled by the dialogue bark manager
+ */
+UCLASS(ClassGroup=(Custom), DisplayName="Dialogue Bark", meta=(BlueprintSpawnableComponent))
+class UTDIALOGUE_API UDialogueBarkComponent final : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueBarkComponent();
+
+	/**
+	 * @brief An array of lines that can be spoken by the owner of this component
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks")
+	TArray<FText> BarkLines;
+
+	/**
+	 * @brief The voice list used when playing a bark
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks")
+	TSubclassOf<UDialogueVoiceList> BarkVoices;
+
+	/**
+	 * @brief The seed used to select voice files for this speaker. 0 uses a different seed every time play begins
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks")
+	int VoiceSeed;
+
+	/**
+	 * @brief The importance of this speaker. Speakers with a higher importance are preferred over closer speakers
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks", meta = (ClampMin = "0.0"))
+	float Importance;
+
+	/**
+	 * @brief Should the speaker bark automatically using the specified interval?
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks")
+	bool AutoBark;
+
+	/**
+	 * @brief The minimum time in seconds between two automatic barks
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks", meta = (ClampMin = "0.0"))
+	float MinBarkInterval;
+
+	/**
+	 * @brief The maximum time in seconds between two automatic barks
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks", meta = (ClampMin = "0.0"))
+	float MaxBarkInterval;
+
+	/**
+	 * @brief The minimum time in seconds a bark subtitle is displayed
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks", meta = (ClampMin = "0.0"))
+	float MinDisplayTime;
+
+	/**
+	 * @brief The time in seconds added to the display time for every character in the bark
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks", meta = (ClampMin = "0.0"))
+	float DisplayTimePerCharacter;
+
+	/**
+	 * @brief Request a bark from the bark manager. The bark is only played if the scheduler has budget for it
+	 * @param LineIndex The index of the line to play or -1 to play a random line
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void RequestBark(int LineIndex = -1);
+
+	/**
+	 * @brief Get the time in seconds the specified line should be displayed
+	 * @param LineIndex The index of the line
+	 * @return The time in seconds the specified line should be displayed
+	 */
+	float GetDisplayTime(int LineIndex) const;
+
+	/**
+	 * @brief Get a random time in seconds until the next automatic bark
+	 * @return A random time in seconds until the next automatic bark
+	 */
+	float GetRandomBarkInterval() const;
+
+	/**
+	 * @brief Get the index of a random bark line
+	 * @return The index of a random bark line or -1 if the speaker has no bark lines
+	 */
+	int GetRandomBarkLine() const;
+
+protected:
+	/**
+	 * @brief Begins Play for the component
+	 */
+	virtual void BeginPlay() override;
+
+	/**
+	 * @brief Ends gameplay for this component
+	 * @param EndPlayReason The reason why gameplay is ending
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/**
+	 * @brief The bark manager this component is registered with
+	 */
+	UPROPERTY()
+	class ADialogueBarkManager* BarkManager;
+
+	/**
+	 * @brief The index of this speaker in the bark manager. Used to unregister in constant time
+	 */
+	int SpeakerIndex;
+
+	/**
+	 * @brief Selects the voice files of this speaker using a seeded random stream
+	 */
+	FDialogueVoiceSelector VoiceSelector;
+
+	/**
+	 * @brief The random stream used to select the bark lines and the intervals between the barks of this speaker
+	 */
+	FRandomStream BarkRandom;
+
+	friend class ADialogueBarkManager;
+};
\ No newline at end of file
@@ -1,10 +1,14 @@
 ﻿#pragma once
 
 #include "Audio/DialogueVoiceList.h"
+#include "Core/DialogueLineProvider.h"
+#include "Core/DialoguePreparedConversation.h"
 #include "UI/DialogueInteractWidget.h"
 #include "UI/DialogueWidget.h"
 #include "DialogueTrigger.generated.h"
 
+class ADialogueManager;
+
 /**
  * @brief Contains all the information for a dialogue and handles the interaction
  */
@@ -14,6 +18,12 @@ class UTDIALOGUE_API UDialogueTrigger final : public UActorComponent
 	GENERATED_BODY()
 	
 public:
+	/**
+	 * @brief The stable ID of the conversation. The path of the component is used when no ID is specified
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Properties")
+	FName ConversationId;
+
 	/**
 	 * @brief A reference to the player class. This is used to check if the player is entering the trigger
 	 */
@@ -56,12 +66,67 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Properties")
 	TArray<TSubclassOf<UDialogueVoiceList>> DialogueVoices;
 
+	/**
+	 * @brief The choices shown after every line. Lines without choices continue to the next line
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Properties")
+	TArray<FDialogueChoiceSet> DialogueChoices;
+
+	/**
+	 * @brief The cues fired while every line is typed. Lines without cues don't fire any events
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Properties")
+	TArray<FDialogueCueTrack> DialogueCues;
+
+	/**
+	 * @brief Named arguments formatted into the titles, messages and choices, for example {PlayerName}
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Properties")
+	TMap<FString, FText> DialogueArguments;
+
+	/**
+	 * @brief Optional provider of the messages at runtime. The static messages are used when it does not respond in time
+	 */
+	UPROPERTY(EditAnywhere, Instanced, BlueprintReadWrite, Category = "Dialogue|Provider")
+	UDialogueLineProvider* LineProvider;
+
+	/**
+	 * @brief The context sent to the line provider. Provided lines are cached per context
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Provider")
+	FName LineContext;
+
+	/**
+	 * @brief The number of lines requested ahead of the current line
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Provider", meta = (ClampMin = "0"))
+	int PrefetchLineCount = 3;
+
 	/**
 	 * @brief Show the dialogue widget using the provided information
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
 	void ShowDialogue();
 
+	/**
+	 * @brief Start preparing the text of the conversation on a background task. Called when the player enters the
+	 * trigger. The text is prepared again when the dialogue properties changed before the dialogue is shown
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void PrepareDialogue();
+
+	/**
+	 * @brief Cancel the background preparation and release the prepared text
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void CancelPreparation();
+
+	/**
+	 * @brief Copy the data used to prepare the conversation. Must be called on the game thread
+	 * @return The data used to prepare the conversation
+	 */
+	FDialoguePreparationSource MakePreparationSource() const;
+
 	/**
 	 * @brief Show the dialogue interact widget using the provided information
 	 */
@@ -74,13 +139,103 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
 	void HideInteractWidget();
 
+	/**
+	 * @brief Get the stable ID of the conversation
+	 * @return The stable ID of the conversation
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	FName GetConversationId() const;
+
+	/**
+	 * @brief Get the handle of the conversation in the dialogue subsystem. The handle can change after loading a save
+	 * @return The handle of the conversation or -1 if the dialogue subsystem is not available
+	 */
+	int GetConversationHandle();
+
+	/**
+	 * @brief Request the specified line and the next lines from the line provider without waiting for them
+	 * @param FirstLine The index of the first line to request
+	 */
+	void PrefetchProvidedLines(int FirstLine);
+
+	/**
+	 * @brief Get the message of a line from the line provider if it is available
+	 * @param Line The index of the line
+	 * @param OutMessage The provided message. Empty if the provider did not replace the static message
+	 * @return A boolean value indicating if the line provider responded
+	 */
+	bool TryGetProvidedLine(int Line, FText& OutMessage);
+
+	/**
+	 * @brief Forget the requests to the line provider that were not used yet
+	 */
+	void CancelProvidedLines();
+
+#if WITH_EDITOR
+	/**
+	 * @brief Validate the dialogue data. Used by the editor data validation and the dialogue validation commandlet
+	 * @param ValidationErrors The errors found while validating the data
+	 * @return The result of the validation
+	 */
+	virtual EDataValidationResult IsDataValid(TArray<FText>& ValidationErrors) override;
+#endif
+
 protected:
 	/**
 	 * @brief Begins Play for the component
 	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * @brief Ends gameplay for this component
+	 * @param EndPlayReason The reason why gameplay is ending
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
+	/**
+	 * @brief The dialogue manager this trigger is registered with
+	 */
+	TWeakObjectPtr<ADialogueManager> DialogueManager;
+
+	/**
+	 * @brief The index of this trigger in the dialogue manager. Used to unregister in constant time
+	 */
+	int ManagerIndex = INDEX_NONE;
+
+	/**
+	 * @brief Get the dialogue manager this trigger is registered with. Registers with the manager of the world if the
+	 * trigger is not registered yet
+	 * @return The dialogue manager or nullptr if the world has no dialogue manager
+	 */
+	ADialogueManager* GetDialogueManager();
+
+	/**
+	 * @brief The background task preparing the conversation. Invalid when no preparation is running
+	 */
+	TFuture<TSharedPtr<const FDialoguePreparedConversation, ESPMode::ThreadSafe>> PreparationTask;
+
+	/**
+	 * @brief Set to stop the running preparation task early
+	 */
+	TSharedPtr<std::atomic<bool>, ESPMode::ThreadSafe> PreparationCancelled;
+
+	/**
+	 * @brief The prepared conversation. Reused while the player stays inside the trigger
+	 */
+	TSharedPtr<const FDialoguePreparedConversation, ESPMode::ThreadSafe> PreparedConversation;
+
+	/**
+	 * @brief The data the prepared conversation was made from. Compared with the dialogue properties before the
+	 * conversation is shown, because the properties can be changed at any time
+	 */
+	FDialoguePreparationSource PreparedSource;
+
+	/**
+	 * @brief Boolean value indicating if the player is inside the trigger
+	 */
+	bool PlayerInside = false;
+
 	/**
 	 * @brief Called when another actor begins to overlap the parent actor
 	 * @param OverlappedActor The actor that triggered the overlap event
@@ -97,6 +252,20 @@ private:
 	UFUNCTION()
 	void OnActorEndOverlap(AActor* OverlappedActor, AActor* OtherActor);
 
+	/**
+	 * @brief Get the prepared conversation. Uses the result of the preparation task when it is finished and prepares the
+	 * conversation on the game thread otherwise
+	 * @return The prepared conversation
+	 */
+	TSharedRef<const FDialoguePreparedConversation, ESPMode::ThreadSafe> GetPreparedConversation();
+
+	/**
+	 * @brief Check if the dialogue properties still match the data the conversation was prepared from. Only compares
+	 * the identity of the texts, so no text is formatted or converted
+	 * @return A boolean value indicating if the prepared conversation is up to date
+	 */
+	bool IsPreparationCurrent() const;
+
 	/**
 	 * @brief Get a reference to the interact widget
 	 * @return A reference to the interact widget
@@ -108,4 +277,6 @@ private:
 	 * @return A reference to the dialogue widget
 	 */
 	UDialogueWidget* GetDialogueWidget() const;
+
+	friend class ADialogueManager;
 };
\ No newline at end of file
@@ -0,0 +1,318 @@
+﻿#pragma once
+
+#include "Components/DialogueBarkComponent.h"
+#include "Components/WidgetComponent.h"
+#include "UI/DialogueBarkWidget.h"
+#include "DialogueBarkManager.generated.h"
+
+/**
+ * @brief The level of detail used when playing a bark
+ */
+UENUM(BlueprintType)
+enum class EDialogueBarkLod : uint8
+{
+	Full UMETA(DisplayName = "Text and voice"),
+	TextOnly UMETA(DisplayName = "Text only"),
+	VoiceOnly UMETA(DisplayName = "Voice only"),
+	Culled UMETA(DisplayName = "Culled")
+};
+
+/**
+ * @brief A speaker registered with the bark manager
+ */
+struct FDialogueBarkSpeaker
+{
+	/**
+	 * @brief The bark component of the speaker
+	 */
+	TWeakObjectPtr<UDialogueBarkComponent> Component;
+
+	/**
+	 * @brief The world time when the speaker is allowed to bark again
+	 */
+	float NextBarkTime = 0.0f;
+
+	/**
+	 * @brief The line requested by the speaker or -1 if a random line should be played
+	 */
+	int RequestedLine = INDEX_NONE;
+
+	/**
+	 * @brief Boolean value indicating if the speaker explicitly requested a bark
+	 */
+	bool HasRequest = false;
+
+	/**
+	 * @brief The index of the slot playing a bark for this speaker or -1 if the speaker is not barking
+	 */
+	int ActiveSlot = INDEX_NONE;
+};
+
+/**
+ * @brief A speaker that passed the distance and visibility checks during the current frame
+ */
+struct FDialogueBarkCandidate
+{
+	/**
+	 * @brief The index of the speaker in the array of registered speakers
+	 */
+	int SpeakerIndex = INDEX_NONE;
+
+	/**
+	 * @brief The priority of the bark. Candidates with a higher priority are played first
+	 */
+	float Priority = 0.0f;
+
+	/**
+	 * @brief The level of detail used to play the bark
+	 */
+	EDialogueBarkLod Lod = EDialogueBarkLod::Culled;
+};
+
+/**
+ * @brief A slot that is used to play a single bark. Slots are created once and reused
+ */
+struct FDialogueBarkSlot
+{
+	/**
+	 * @brief The index of the speaker using this slot or -1 if the slot is free
+	 */
+	int SpeakerIndex = INDEX_NONE;
+
+	/**
+	 * @brief The world time when the bark should be stopped
+	 */
+	float EndTime = 0.0f;
+};
+
+/**
+ * @brief Schedules the ambient barks of all the registered speakers using a fixed per-frame budget
+ */
+UCLASS()
+class UTDIALOGUE_API ADialogueBarkManager final : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ADialogueBarkManager();
+
+	/**
+	 * @brief The widget class used to display the subtitle of a bark
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks")
+	TSubclassOf<UDialogueBarkWidget> BarkWidgetClass;
+
+	/**
+	 * @brief The space used to render the bark subtitles
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks")
+	EWidgetSpace SubtitleSpace;
+
+	/**
+	 * @brief The offset of the subtitle relative to the root of the speaker
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks")
+	FVector SubtitleOffset;
+
+	/**
+	 * @brief The attenuation settings used when playing the voice of a bark
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Barks")
+	USoundAttenuation* VoiceAttenuation;
+
+	/**
+	 * @brief The maximum number of barks that can be played at the same time
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Dialogue|Budget", meta = (ClampMin = "1"))
+	int MaxConcurrentBarks;
+
+	/**
+	 * @brief The maximum number of speakers evaluated every frame. This keeps the per-frame cost fixed
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Budget", meta = (ClampMin = "1"))
+	int MaxEvaluationsPerFrame;
+
+	/**
+	 * @brief The time in seconds before a speaker that was not selected is evaluated again
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Budget", meta = (ClampMin = "0.0"))
+	float RetryDelay;
+
+	/**
+	 * @brief The priority added to barks that were explicitly requested
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Budget", meta = (ClampMin = "0.0"))
+	float RequestPriorityBonus;
+
+	/**
+	 * @brief Barks closer than this distance are played with text and voice
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|LOD", meta = (ClampMin = "0.0"))
+	float FullDetailDistance;
+
+	/**
+	 * @brief Barks further than this distance are culled
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|LOD", meta = (ClampMin = "0.0"))
+	float MaxBarkDistance;
+
+	/**
+	 * @brief The level of detail used between the full detail distance and the max bark distance
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|LOD")
+	EDialogueBarkLod ReducedDetailLod;
+
+	/**
+	 * @brief Should speakers that were not recently rendered be culled?
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|LOD")
+	bool CullOffscreenSpeakers;
+
+	/**
+	 * @brief The time in seconds a speaker is still considered on screen after it was last rendered
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|LOD", meta = (ClampMin = "0.0"))
+	float OffscreenTolerance;
+
+	/**
+	 * @brief Function called every frame on this actor
+	 * @param DeltaSeconds The time since the last tick
+	 */
+	virtual void Tick(float DeltaSeconds) override;
+
+	/**
+	 * @brief Register a speaker with the bark manager
+	 * @param Speaker The bark component of the speaker
+	 */
+	void RegisterSpeaker(UDialogueBarkComponent* Speaker);
+
+	/**
+	 * @brief Unregister a speaker from the bark manager and stop its active bark
+	 * @param Speaker The bark component of the speaker
+	 */
+	void UnregisterSpeaker(UDialogueBarkComponent* Speaker);
+
+	/**
+	 * @brief Request a bark for the specified speaker
+	 * @param Speaker The bark component of the speaker
+	 * @param LineIndex The index of the line to play or -1 to play a random line
+	 */
+	void RequestBark(const UDialogueBarkComponent* Speaker, int LineIndex);
+
+	/**
+	 * @brief Get the number of barks that are currently playing
+	 * @return The number of barks that are currently playing
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	int GetActiveBarkCount() const;
+
+	/**
+	 * @brief Evaluate a speaker and calculate the priority and level of detail of its bark
+	 * @param DistanceSquared The squared distance between the listener and the speaker
+	 * @param Importance The importance of the speaker
+	 * @param HasRequest Boolean value indicating if the bark was explicitly requested
+	 * @param OutCandidate The candidate that is updated with the priority and level of detail
+	 * @return A boolean value indicating if the speaker should be considered for a bark
+	 */
+	bool EvaluateCandidate(float DistanceSquared, float Importance, bool HasRequest,
+		FDialogueBarkCandidate& OutCandidate) const;
+
+	/**
+	 * @brief Sort the candidates so that the candidates with the highest priority are at the start of the array
+	 * @param Candidates The candidates evaluated during the current frame
+	 * @param FreeSlots The number of barks that can still be started
+	 */
+	static void SelectCandidates(TArray<FDialogueBarkCandidate>& Candidates, int FreeSlots);
+
+	/**
+	 * @brief Run the scheduler of a temporary bark manager against synthetic speakers and log the cost per frame.
+	 * The speakers and the manager are destroyed after the benchmark
+	 * @param World The world used to spawn the manager and the speakers
+	 * @param NumSpeakers The number of synthetic speakers
+	 * @param NumFrames The number of frames to simulate
+	 */
+	static void RunSchedulerBenchmark(UWorld* World, int NumSpeakers, int NumFrames);
+
+protected:
+	/**
+	 * @brief Called when the game starts or when spawned
+	 */
+	virtual void BeginPlay() override;
+
+private:
+	/**
+	 * @brief All the speakers registered with the bark manager
+	 */
+	TArray<FDialogueBarkSpeaker> Speakers;
+
+	/**
+	 * @brief The slots used to play the barks
+	 */
+	TArray<FDialogueBarkSlot> Slots;
+
+	/**
+	 * @brief The subtitle component of every slot
+	 */
+	UPROPERTY()
+	TArray<UWidgetComponent*> SubtitleComponents;
+
+	/**
+	 * @brief The voice component of every slot
+	 */
+	UPROPERTY()
+	TArray<UAudioComponent*> VoiceComponents;
+
+	/**
+	 * @brief The candidates evaluated during the current frame. The memory is reused every frame
+	 */
+	TArray<FDialogueBarkCandidate> Candidates;
+
+	/**
+	 * @brief The index of the next speaker that will be evaluated
+	 */
+	int EvaluationCursor;
+
+	/**
+	 * @brief Create the subtitle and voice components used by the slots
+	 */
+	void CreateSlots();
+
+	/**
+	 * @brief Stop the barks that are finished or whose speaker is no longer valid
+	 * @param Now The current world time
+	 */
+	void UpdateActiveBarks(float Now);
+
+	/**
+	 * @brief Evaluate the next batch of speakers and add the valid speakers to the candidates
+	 * @param ListenerLocation The location of the listener
+	 * @param Now The current world time
+	 */
+	void EvaluateSpeakers(const FVector& ListenerLocation, float Now);
+
+	/**
+	 * @brief Start the barks of the candidates with the highest priority
+	 * @param Now The current world time
+	 */
+	void StartBarks(float Now);
+
+	/**
+	 * @brief Start a bark in the specified slot
+	 * @param SlotIndex The index of the slot
+	 * @param Candidate The candidate that will use the slot
+	 * @param Now The current world time
+	 */
+	void StartBark(int SlotIndex, const FDialogueBarkCandidate& Candidate, float Now);
+
+	/**
+	 * @brief Stop the bark in the specified slot
+	 * @param SlotIndex The index of the slot
+	 */
+	void StopBark(int SlotIndex);
+
+	/**
+	 * @brief Get the index of a slot that is not playing a bark
+	 * @return The index of a free slot or -1 if all the slots are used
+	 */
+	int GetFreeSlot() const;
+};
\ No newline at end of file
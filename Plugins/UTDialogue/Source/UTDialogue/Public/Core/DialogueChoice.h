@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueChoice.generated.h"
+
+/**
+ * @brief A response the player can pick after a line
+ */
+USTRUCT(BlueprintType)
+struct FDialogueChoice
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief The text displayed in the choice menu
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Choice")
+	FText Text;
+
+	/**
+	 * @brief The index of the line shown after picking this choice or -1 to end the conversation
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Choice", meta = (ClampMin = "-1"))
+	int NextLine = INDEX_NONE;
+
+	/**
+	 * @brief The name of the dialogue variable changed when picking this choice. No variable is changed if not set
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Choice")
+	FName VariableName;
+
+	/**
+	 * @brief The value assigned to the dialogue variable when picking this choice
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Choice")
+	int VariableValue = 0;
+};
+
+/**
+ * @brief The choices shown after a single line. Lines without choices continue to the next line
+ */
+USTRUCT(BlueprintType)
+struct FDialogueChoiceSet
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief The choices shown after the line
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Choice")
+	TArray<FDialogueChoice> Choices;
+};
\ No newline at end of file
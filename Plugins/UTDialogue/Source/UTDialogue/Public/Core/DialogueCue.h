@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueCue.generated.h"
+
+/**
+ * @brief The unit of the offset of a cue
+ */
+UENUM(BlueprintType)
+enum class EDialogueCueUnit : uint8
+{
+	Characters UMETA(DisplayName = "Characters (source culture only)"),
+	PerMille UMETA(DisplayName = "Per mille of the line")
+};
+
+/**
+ * @brief A gameplay event fired when the typing animation reaches a character of a line
+ */
+USTRUCT(BlueprintType)
+struct FDialogueCue
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief The position that fires the cue. 0 fires the cue when the line starts. A number of characters only
+	 * matches the culture the line was written in, while a per mille offset follows the length of every translation
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Cue", meta = (ClampMin = "0"))
+	int Offset = 0;
+
+	/**
+	 * @brief The unit of the offset
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Cue")
+	EDialogueCueUnit Unit = EDialogueCueUnit::Characters;
+
+	/**
+	 * @brief The name of the event, for example a camera cut, an animation, an emote or a sound stinger
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Cue")
+	FName Event;
+
+	/**
+	 * @brief Get the number of revealed characters that fires the cue
+	 * @param MessageLength The length of the message in the current culture
+	 * @return The number of revealed characters that fires the cue
+	 */
+	int GetCharacterOffset(const int MessageLength) const
+	{
+		return Unit == EDialogueCueUnit::PerMille
+			? static_cast<int>((static_cast<int64>(Offset) * MessageLength + 999) / 1000)
+			: Offset;
+	}
+};
+
+/**
+ * @brief The cues of a single line sorted by offset
+ */
+USTRUCT(BlueprintType)
+struct FDialogueCueTrack
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief The cues of the line. Cues with the same offset fire in the order of the array
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Cue")
+	TArray<FDialogueCue> Cues;
+};
\ No newline at end of file
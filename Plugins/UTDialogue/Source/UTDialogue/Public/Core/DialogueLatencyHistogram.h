@@ -0,0 +1,94 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief A fixed-size histogram of latencies in milliseconds. The buckets grow exponentially with four buckets per
+ * doubling, so percentiles are accurate within 19% from 0.125 ms to about 7 seconds and adding a sample never allocates
+ */
+class UTDIALOGUE_API FDialogueLatencyHistogram
+{
+public:
+	/**
+	 * @brief Add a latency to the histogram
+	 * @param Milliseconds The latency in milliseconds
+	 */
+	void Add(float Milliseconds);
+
+	/**
+	 * @brief Remove all the latencies from the histogram
+	 */
+	void Reset();
+
+	/**
+	 * @brief Get the number of latencies in the histogram
+	 * @return The number of latencies in the histogram
+	 */
+	int Num() const
+	{
+		return Count;
+	}
+
+	/**
+	 * @brief Get the highest latency in the histogram
+	 * @return The highest latency in milliseconds
+	 */
+	float GetMax() const
+	{
+		return Max;
+	}
+
+	/**
+	 * @brief Get the latency below which the specified percentage of the latencies fall
+	 * @param Percentile The percentage between 0 and 100
+	 * @return The upper bound of the bucket containing the percentile in milliseconds or 0 if the histogram is empty
+	 */
+	float GetPercentile(float Percentile) const;
+
+	/**
+	 * @brief Get the fraction of the latencies that are higher than the specified budget
+	 * @param Milliseconds The latency budget in milliseconds
+	 * @return The fraction of the latencies over the budget between 0 and 1
+	 */
+	float GetFractionAbove(float Milliseconds) const;
+
+private:
+	/**
+	 * @brief The number of buckets in the histogram
+	 */
+	static constexpr int NumBuckets = 64;
+
+	/**
+	 * @brief The upper bound of the first bucket in milliseconds
+	 */
+	static constexpr float FirstBucketBound = 0.125f;
+
+	/**
+	 * @brief The number of latencies in every bucket
+	 */
+	uint32 Buckets[NumBuckets] = {};
+
+	/**
+	 * @brief The number of latencies in the histogram
+	 */
+	int Count = 0;
+
+	/**
+	 * @brief The highest latency in milliseconds
+	 */
+	float Max = 0.0f;
+
+	/**
+	 * @brief Get the bucket of the specified latency
+	 * @param Milliseconds The latency in milliseconds
+	 * @return The index of the bucket
+	 */
+	static int GetBucket(float Milliseconds);
+
+	/**
+	 * @brief Get the upper bound of the specified bucket
+	 * @param Bucket The index of the bucket
+	 * @return The upper bound of the bucket in milliseconds
+	 */
+	static float GetBucketBound(int Bucket);
+};
\ No newline at end of file
@@ -0,0 +1,107 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief A dense bitset with one bit per dialogue line. Changed words are tracked to support incremental saves
+ */
+class UTDIALOGUE_API FDialogueLineBitset
+{
+public:
+	/**
+	 * @brief Change the number of bits in the bitset. New bits are cleared
+	 * @param NewNum The number of bits
+	 */
+	void SetNum(int NewNum);
+
+	/**
+	 * @brief Get the number of bits in the bitset
+	 * @return The number of bits in the bitset
+	 */
+	int Num() const
+	{
+		return NumBits;
+	}
+
+	/**
+	 * @brief Check if the specified bit is set
+	 * @param Bit The index of the bit
+	 * @return A boolean value indicating if the bit is set
+	 */
+	bool Get(const int Bit) const
+	{
+		return Bit >= 0 && Bit < NumBits && (Words[Bit >> 5] & (1u << (Bit & 31))) != 0;
+	}
+
+	/**
+	 * @brief Set the specified bit and mark the word as changed
+	 * @param Bit The index of the bit
+	 */
+	void Set(int Bit);
+
+	/**
+	 * @brief Remove all the bits
+	 */
+	void Empty();
+
+	/**
+	 * @brief Get the number of 32-bit words used by the bitset
+	 * @return The number of words used by the bitset
+	 */
+	int NumWords() const
+	{
+		return Words.Num();
+	}
+
+	/**
+	 * @brief Get a word from the bitset
+	 * @param WordIndex The index of the word
+	 * @return The word at the specified index
+	 */
+	uint32 GetWord(const int WordIndex) const
+	{
+		return Words[WordIndex];
+	}
+
+	/**
+	 * @brief Replace a word in the bitset. The bitset grows if needed and the word is not marked as changed
+	 * @param WordIndex The index of the word
+	 * @param Word The new value of the word
+	 */
+	void SetWord(int WordIndex, uint32 Word);
+
+	/**
+	 * @brief Get the indices of the words that changed since the changes were last cleared
+	 * @return The indices of the words that changed
+	 */
+	const TArray<int>& GetDirtyWords() const
+	{
+		return DirtyWords;
+	}
+
+	/**
+	 * @brief Forget the words that changed
+	 */
+	void ClearDirtyWords();
+
+private:
+	/**
+	 * @brief The words of the bitset
+	 */
+	TArray<uint32> Words;
+
+	/**
+	 * @brief One bit per word indicating if the word is already in the array of dirty words
+	 */
+	TArray<uint32> DirtyMask;
+
+	/**
+	 * @brief The indices of the words that changed
+	 */
+	TArray<int> DirtyWords;
+
+	/**
+	 * @brief The number of bits in the bitset
+	 */
+	int NumBits = 0;
+};
\ No newline at end of file
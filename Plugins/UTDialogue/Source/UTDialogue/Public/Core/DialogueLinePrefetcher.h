@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+#include "Core/DialogueLineProvider.h"
+
+/**
+ * @brief Identifies a provided line. The same line can have a different message in every context and culture
+ */
+struct FDialogueLineKey
+{
+	/**
+	 * @brief The stable ID of the conversation
+	 */
+	FName ConversationId;
+
+	/**
+	 * @brief The index of the line in the conversation
+	 */
+	int Line = INDEX_NONE;
+
+	/**
+	 * @brief The context of the conversation
+	 */
+	FName Context;
+
+	/**
+	 * @brief The name of the culture of the message
+	 */
+	FName Culture;
+
+	bool operator==(const FDialogueLineKey& Other) const
+	{
+		return Line == Other.Line && ConversationId == Other.ConversationId && Context == Other.Context
+			&& Culture == Other.Culture;
+	}
+
+	friend uint32 GetTypeHash(const FDialogueLineKey& Key)
+	{
+		return HashCombine(HashCombine(HashCombine(GetTypeHash(Key.ConversationId), GetTypeHash(Key.Context)),
+			GetTypeHash(Key.Culture)), Key.Line);
+	}
+};
+
+/**
+ * @brief Requests lines from line providers ahead of time and keeps the results in a least recently used cache.
+ * Only used on the game thread
+ */
+class UTDIALOGUE_API FDialogueLinePrefetcher
+{
+public:
+	/**
+	 * @brief Create a prefetcher
+	 * @param CacheCapacity The maximum number of provided lines in the cache
+	 */
+	explicit FDialogueLinePrefetcher(int CacheCapacity = 256);
+
+	/**
+	 * @brief Request a line unless it is already cached or requested. A provider that returns no future provides no
+	 * line, so an empty message is cached and the static message is used
+	 * @param Provider The provider of the line
+	 * @param Request The line to request
+	 */
+	void Prefetch(UDialogueLineProvider* Provider, const FDialogueLineRequest& Request);
+
+	/**
+	 * @brief Get a provided line if it is available. Completed requests are moved to the cache
+	 * @param Key The line to get
+	 * @param OutMessage The provided message
+	 * @return A boolean value indicating if the line is available
+	 */
+	bool TryGetLine(const FDialogueLineKey& Key, FText& OutMessage);
+
+	/**
+	 * @brief Forget the pending requests of a conversation. The provider might still complete them, but the results
+	 * are not kept. Used when the conversation ends or the player leaves its trigger
+	 * @param ConversationId The stable ID of the conversation
+	 */
+	void CancelRequests(FName ConversationId);
+
+	/**
+	 * @brief Forget all the cached lines and pending requests
+	 */
+	void Reset();
+
+	/**
+	 * @brief Compare the time spent waiting for a mock provider with and without prefetching and log the result. The
+	 * simulated conversations run on the core ticker one after another, so the game thread is never blocked
+	 * @param NumLines The number of lines in the simulated conversation
+	 * @param Latency The latency of the mock provider in seconds
+	 * @param TypingTime The time in seconds spent typing every line
+	 * @param PrefetchCounts The number of lines requested ahead of the current line in every simulated conversation
+	 */
+	static void RunPrefetchBenchmark(int NumLines, float Latency, float TypingTime, const TArray<int>& PrefetchCounts);
+
+private:
+	/**
+	 * @brief The provided lines that were used most recently
+	 */
+	TLruCache<FDialogueLineKey, FText> Cache;
+
+	/**
+	 * @brief The requests that are not completed yet
+	 */
+	TMap<FDialogueLineKey, TFuture<FText>> PendingRequests;
+};
\ No newline at end of file
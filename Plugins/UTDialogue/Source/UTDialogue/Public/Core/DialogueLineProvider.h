@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "DialogueLineProvider.generated.h"
+
+/**
+ * @brief The information sent to a line provider when a line is requested
+ */
+struct FDialogueLineRequest
+{
+	/**
+	 * @brief The stable ID of the conversation
+	 */
+	FName ConversationId;
+
+	/**
+	 * @brief The index of the line in the conversation
+	 */
+	int Line = INDEX_NONE;
+
+	/**
+	 * @brief The context of the conversation, for example the mood of the speaker
+	 */
+	FName Context;
+
+	/**
+	 * @brief The name of the culture the message is requested in
+	 */
+	FName Culture;
+
+	/**
+	 * @brief The title of the line
+	 */
+	FText Title;
+
+	/**
+	 * @brief The static message of the line. Shown when the provider does not respond in time
+	 */
+	FText FallbackMessage;
+};
+
+/**
+ * @brief Provides the messages of a conversation at runtime, for example from a procedural generator or a local
+ * service. Requests must not block the game thread
+ */
+UCLASS(Abstract, EditInlineNew, DefaultToInstanced, BlueprintType)
+class UTDIALOGUE_API UDialogueLineProvider : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief Request the message of a line. The future can be completed on any thread
+	 * @param Request The line that is requested
+	 * @return The message of the line. An empty message or an invalid future uses the static message
+	 */
+	virtual TFuture<FText> RequestLine(const FDialogueLineRequest& Request)
+		PURE_VIRTUAL(UDialogueLineProvider::RequestLine, return TFuture<FText>(););
+};
\ No newline at end of file
@@ -12,6 +12,33 @@ class UTDIALOGUE_API ADialogueManager final : public AActor
 	GENERATED_BODY()
 	
 public:
+	/**
+	 * @brief Get the dialogue manager of the world used by the specified object
+	 * @param WorldContextObject The object used to find the world
+	 * @return The dialogue manager or nullptr if the world has no dialogue manager
+	 */
+	static ADialogueManager* Get(const UObject* WorldContextObject);
+
+	/**
+	 * @brief Register a dialogue trigger after it began play
+	 * @param DialogueTrigger The dialogue trigger to register
+	 */
+	void RegisterDialogueTrigger(UDialogueTrigger* DialogueTrigger);
+
+	/**
+	 * @brief Unregister a dialogue trigger before it is destroyed or streamed out. The prompt of the trigger is hidden
+	 * and another trigger the player is inside takes over. A conversation that is shown continues until it is dismissed
+	 * @param DialogueTrigger The dialogue trigger to unregister
+	 */
+	void UnregisterDialogueTrigger(UDialogueTrigger* DialogueTrigger);
+
+	/**
+	 * @brief Get the number of registered dialogue triggers
+	 * @return The number of registered dialogue triggers
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	int GetRegisteredTriggerNum() const;
+
 	/**
 	 * @brief Return a boolean value indicating if the dialogue widget is currently shown
 	 * @return A boolean value indicating if the dialogue widget is currently shown
@@ -51,18 +78,59 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
 	void SkipDialogueMessage();
 
+	/**
+	 * @brief Pick a choice of the current line in the dialogue widget
+	 * @param ChoiceIndex The index of the choice
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void SelectDialogueChoice(int ChoiceIndex);
+
+	/**
+	 * @brief Move the selection in the choice menu of the dialogue widget
+	 * @param Offset The number of choices to move. Negative values move up
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void NavigateDialogueChoice(int Offset);
+
 	/**
 	 * @brief Clean up the UI after the dialogue widget is dismissed
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
 	void OnDialogueDismissed();
 
+	/**
+	 * @brief Restore the dialogue widget after loading a save using the active conversation of the dialogue subsystem
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void RestoreDialogue();
+
+protected:
+	/**
+	 * @brief Overridable native event for when play begins for this actor
+	 */
+	virtual void BeginPlay() override;
+
+	/**
+	 * @brief Overridable function called whenever this actor is being removed from a level
+	 * @param EndPlayReason The reason why gameplay is ending
+	 */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 	/**
 	 * @brief The dialogue trigger that the player is currently inside
 	 */
-	UPROPERTY()
-	UDialogueTrigger* CurrentDialogueTrigger;
+	TWeakObjectPtr<UDialogueTrigger> CurrentDialogueTrigger;
+
+	/**
+	 * @brief The dialogue triggers the player is inside. The most recently entered trigger is last
+	 */
+	TArray<TWeakObjectPtr<UDialogueTrigger>> OverlappedTriggers;
+
+	/**
+	 * @brief All the registered dialogue triggers. Every trigger stores its index so it can be removed in constant time
+	 */
+	TArray<TWeakObjectPtr<UDialogueTrigger>> Triggers;
 
 	/**
 	 * @brief A boolean value indicating if the dialogue widget is currently shown
@@ -70,8 +138,18 @@ private:
 	bool IsShown;
 
 	/**
-	 * @brief Get a reference to the dialogue widget 
+	 * @brief The dialogue widget found by the last search. Cached so skip inputs don't need to search all the widgets
+	 */
+	TWeakObjectPtr<UDialogueWidget> CachedDialogueWidget;
+
+	/**
+	 * @brief Make the most recently entered trigger the current trigger after the current trigger was reset
+	 */
+	void HandOffDialogueTrigger();
+
+	/**
+	 * @brief Get a reference to the dialogue widget. The widget is only searched when the cached widget is not valid
 	 * @return A reference to the dialogue widget
 	 */
-	UDialogueWidget* GetDialogueWidget() const;
+	UDialogueWidget* GetDialogueWidget();
 };
\ No newline at end of file
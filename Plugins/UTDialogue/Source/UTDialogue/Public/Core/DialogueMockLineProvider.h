@@ -0,0 +1,42 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/DialogueLineProvider.h"
+#include "DialogueMockLineProvider.generated.h"
+
+/**
+ * @brief A local line provider that simulates the latency of a real provider. Used for testing and benchmarking
+ */
+UCLASS(DisplayName = "Mock Line Provider")
+class UTDIALOGUE_API UDialogueMockLineProvider final : public UDialogueLineProvider
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueMockLineProvider();
+
+	/**
+	 * @brief The time in seconds before a requested line is available
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Provider", meta = (ClampMin = "0.0"))
+	float Latency;
+
+	/**
+	 * @brief The maximum random time in seconds added to or removed from the latency
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Provider", meta = (ClampMin = "0.0"))
+	float LatencyJitter;
+
+	/**
+	 * @brief The format of the provided message. Supports the {Message}, {Line} and {Context} arguments
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Provider")
+	FText MessageFormat;
+
+	/**
+	 * @brief Request the message of a line. The message is completed by the core ticker after the latency
+	 * @param Request The line that is requested
+	 * @return The message of the line
+	 */
+	virtual TFuture<FText> RequestLine(const FDialogueLineRequest& Request) override;
+};
\ No newline at end of file
@@ -0,0 +1,160 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/DialogueChoice.h"
+#include "Core/DialogueCue.h"
+#include <atomic>
+
+/**
+ * @brief The data copied from a dialogue trigger on the game thread and used to prepare a conversation
+ */
+struct FDialoguePreparationSource
+{
+	/**
+	 * @brief The titles of the lines
+	 */
+	TArray<FText> Titles;
+
+	/**
+	 * @brief The messages of the lines
+	 */
+	TArray<FText> Messages;
+
+	/**
+	 * @brief The choices shown after every line
+	 */
+	TArray<FDialogueChoiceSet> Choices;
+
+	/**
+	 * @brief The cues fired while every line is typed
+	 */
+	TArray<FDialogueCueTrack> Cues;
+
+	/**
+	 * @brief The named arguments formatted into the titles, messages and choices
+	 */
+	FFormatNamedArguments Arguments;
+
+	/**
+	 * @brief The name of the current culture. Read on the game thread, because the culture can change while the
+	 * conversation is prepared on another thread
+	 */
+	FString Culture;
+};
+
+/**
+ * @brief The text of a conversation after formatting and preprocessing. A prepared conversation never changes, so
+ * it is shared between the task that prepared it and the dialogue widget without copying
+ */
+class UTDIALOGUE_API FDialoguePreparedConversation
+{
+public:
+	/**
+	 * @brief Format and preprocess the text of a conversation. Can be called from any thread
+	 * @param Source The data copied from the dialogue trigger
+	 * @param Cancelled Checked between lines. Preparation stops early when it is set
+	 * @return The prepared conversation or nullptr if the preparation was cancelled
+	 */
+	static TSharedPtr<const FDialoguePreparedConversation, ESPMode::ThreadSafe> Prepare(
+		FDialoguePreparationSource&& Source, const std::atomic<bool>* Cancelled = nullptr);
+
+	/**
+	 * @brief Get a conversation without lines
+	 * @return The empty conversation
+	 */
+	static const FDialoguePreparedConversation& GetEmpty();
+
+	/**
+	 * @brief Get the number of lines in the conversation
+	 * @return The number of lines
+	 */
+	int Num() const
+	{
+		return Titles.Num();
+	}
+
+	/**
+	 * @brief Get the formatted titles of the lines
+	 * @return The titles of the lines
+	 */
+	const TArray<FText>& GetTitles() const
+	{
+		return Titles;
+	}
+
+	/**
+	 * @brief Get the formatted messages of the lines
+	 * @return The messages of the lines
+	 */
+	const TArray<FText>& GetMessages() const
+	{
+		return Messages;
+	}
+
+	/**
+	 * @brief Get the messages of the lines as strings in the culture used to prepare the conversation
+	 * @return The messages of the lines as strings
+	 */
+	const TArray<FString>& GetMessageStrings() const
+	{
+		return MessageStrings;
+	}
+
+	/**
+	 * @brief Get the formatted choices shown after every line
+	 * @return The choices of the lines
+	 */
+	const TArray<FDialogueChoiceSet>& GetChoices() const
+	{
+		return Choices;
+	}
+
+	/**
+	 * @brief Get the cues of every line sorted by offset
+	 * @return The cue tracks of the lines
+	 */
+	const TArray<FDialogueCueTrack>& GetCues() const
+	{
+		return Cues;
+	}
+
+	/**
+	 * @brief Get the name of the culture used to build the message strings
+	 * @return The name of the culture
+	 */
+	const FString& GetCulture() const
+	{
+		return Culture;
+	}
+
+private:
+	/**
+	 * @brief The formatted titles of the lines
+	 */
+	TArray<FText> Titles;
+
+	/**
+	 * @brief The formatted messages of the lines
+	 */
+	TArray<FText> Messages;
+
+	/**
+	 * @brief The messages of the lines as strings
+	 */
+	TArray<FString> MessageStrings;
+
+	/**
+	 * @brief The formatted choices shown after every line
+	 */
+	TArray<FDialogueChoiceSet> Choices;
+
+	/**
+	 * @brief The cues of every line sorted by offset
+	 */
+	TArray<FDialogueCueTrack> Cues;
+
+	/**
+	 * @brief The name of the culture used to build the message strings
+	 */
+	FString Culture;
+};
\ No newline at end of file
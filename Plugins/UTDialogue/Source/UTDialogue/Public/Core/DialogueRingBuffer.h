@@ -0,0 +1,113 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * @brief A fixed-capacity buffer that overwrites the oldest element when it is full
+ */
+template <typename ElementType>
+class TDialogueRingBuffer
+{
+public:
+	/**
+	 * @brief Create an empty ring buffer
+	 * @param InCapacity The maximum number of elements stored in the buffer
+	 */
+	explicit TDialogueRingBuffer(const int InCapacity = 0)
+	{
+		SetCapacity(InCapacity);
+	}
+
+	/**
+	 * @brief Change the capacity of the buffer. All the elements are removed
+	 * @param NewCapacity The maximum number of elements stored in the buffer
+	 */
+	void SetCapacity(const int NewCapacity)
+	{
+		Elements.Empty(FMath::Max(NewCapacity, 0));
+		Elements.SetNum(FMath::Max(NewCapacity, 0));
+		Head = 0;
+		Count = 0;
+	}
+
+	/**
+	 * @brief Add an element to the buffer. The oldest element is overwritten if the buffer is full
+	 * @param Element The element to add
+	 */
+	void Add(const ElementType& Element)
+	{
+		if (Elements.Num() == 0)
+		{
+			return;
+		}
+
+		Elements[Head] = Element;
+		Head = (Head + 1) % Elements.Num();
+		Count = FMath::Min(Count + 1, Elements.Num());
+	}
+
+	/**
+	 * @brief Remove all the elements without releasing the memory
+	 */
+	void Reset()
+	{
+		Head = 0;
+		Count = 0;
+	}
+
+	/**
+	 * @brief Get the number of elements in the buffer
+	 * @return The number of elements in the buffer
+	 */
+	int Num() const
+	{
+		return Count;
+	}
+
+	/**
+	 * @brief Get the maximum number of elements stored in the buffer
+	 * @return The maximum number of elements stored in the buffer
+	 */
+	int Capacity() const
+	{
+		return Elements.Num();
+	}
+
+	/**
+	 * @brief Check if the specified index is valid
+	 * @param Index The index to check
+	 * @return A boolean value indicating if the index is valid
+	 */
+	bool IsValidIndex(const int Index) const
+	{
+		return Index >= 0 && Index < Count;
+	}
+
+	/**
+	 * @brief Get an element from the buffer
+	 * @param Index The index of the element. Index 0 is the oldest element in the buffer
+	 * @return The element at the specified index
+	 */
+	const ElementType& operator[](const int Index) const
+	{
+		check(IsValidIndex(Index));
+		const int Oldest = (Head - Count + Elements.Num()) % Elements.Num();
+		return Elements[(Oldest + Index) % Elements.Num()];
+	}
+
+private:
+	/**
+	 * @brief The storage of the buffer. The size never changes after setting the capacity
+	 */
+	TArray<ElementType> Elements;
+
+	/**
+	 * @brief The index where the next element is written
+	 */
+	int Head = 0;
+
+	/**
+	 * @brief The number of valid elements in the buffer
+	 */
+	int Count = 0;
+};
\ No newline at end of file
@@ -0,0 +1,9 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+/**
+ * @brief The stat group used by all the dialogue systems (stat UTDialogue)
+ */
+DECLARE_STATS_GROUP(TEXT("UTDialogue"), STATGROUP_UTDialogue, STATCAT_Advanced);
\ No newline at end of file
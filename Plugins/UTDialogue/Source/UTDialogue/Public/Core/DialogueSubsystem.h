@@ -0,0 +1,441 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/DialogueLatencyHistogram.h"
+#include "Core/DialogueLineBitset.h"
+#include "Core/DialogueLinePrefetcher.h"
+#include "Core/DialogueRingBuffer.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "DialogueSubsystem.generated.h"
+
+class ADialogueManager;
+class UDialogueTrigger;
+class UDialogueWidget;
+
+/**
+ * @brief A conversation known by the dialogue subsystem
+ */
+struct FDialogueConversation
+{
+	/**
+	 * @brief The stable ID of the conversation
+	 */
+	FName Id;
+
+	/**
+	 * @brief The trigger that contains the text of the conversation. Invalid when the trigger is not loaded
+	 */
+	TWeakObjectPtr<UDialogueTrigger> Source;
+
+	/**
+	 * @brief The index of the first line of the conversation in the seen-line bitset
+	 */
+	int FirstLine = 0;
+
+	/**
+	 * @brief The number of lines reserved for the conversation in the seen-line bitset
+	 */
+	int LineCount = 0;
+
+	/**
+	 * @brief The CRC of the stable ID used to identify the conversation in the telemetry
+	 */
+	uint32 TelemetryId = 0;
+
+	/**
+	 * @brief Boolean value indicating if the conversation changed since the last save
+	 */
+	bool Dirty = true;
+};
+
+/**
+ * @brief A line in the dialogue history. Only the IDs are stored and the text is resolved when needed
+ */
+struct FDialogueHistoryEntry
+{
+	/**
+	 * @brief The handle of the conversation in the dialogue subsystem
+	 */
+	int Conversation = INDEX_NONE;
+
+	/**
+	 * @brief The index of the line in the conversation
+	 */
+	int Line = INDEX_NONE;
+};
+
+/**
+ * @brief The conversation that is currently shown in the dialogue widget
+ */
+struct FDialogueActiveState
+{
+	/**
+	 * @brief The handle of the conversation or -1 if no conversation is shown
+	 */
+	int Conversation = INDEX_NONE;
+
+	/**
+	 * @brief The index of the current line
+	 */
+	int Line = 0;
+
+	/**
+	 * @brief The number of characters revealed in the current line
+	 */
+	int TypingIndex = 0;
+};
+
+/**
+ * @brief Keeps track of the dialogue state that lives for the whole game session
+ */
+UCLASS()
+class UTDIALOGUE_API UDialogueSubsystem final : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief Initialize the subsystem
+	 * @param Collection The collection of subsystems
+	 */
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	/**
+	 * @brief Deinitialize the subsystem and close the telemetry log
+	 */
+	virtual void Deinitialize() override;
+
+	/**
+	 * @brief Get the dialogue subsystem of the game instance used by the specified object
+	 * @param WorldContextObject The object used to find the game instance
+	 * @return The dialogue subsystem or nullptr if the game instance is not valid
+	 */
+	static UDialogueSubsystem* Get(const UObject* WorldContextObject);
+
+	/**
+	 * @brief Get the dialogue manager of the current world
+	 * @return The dialogue manager or nullptr if no dialogue manager began play
+	 */
+	ADialogueManager* GetDialogueManager() const;
+
+	/**
+	 * @brief Change the dialogue manager of the current world
+	 * @param DialogueManager The dialogue manager or nullptr to clear it
+	 */
+	void SetDialogueManager(ADialogueManager* DialogueManager);
+
+	/**
+	 * @brief Get the prefetcher used to request lines from line providers
+	 * @return The prefetcher shared by all the conversations
+	 */
+	FDialogueLinePrefetcher& GetLinePrefetcher();
+
+	/**
+	 * @brief Get the time when the current frame started. Unlike the application time it is not advanced by a fixed
+	 * time step, so it can be compared with FPlatformTime::Seconds
+	 * @return The time in seconds when the current frame started
+	 */
+	double GetFrameStartTime() const;
+
+	/**
+	 * @brief Record the time between a skip input and the first visible change of the message
+	 * @param Milliseconds The latency in milliseconds
+	 */
+	void RecordInputLatency(float Milliseconds);
+
+	/**
+	 * @brief Get the histogram of the time between a skip input and the first visible change of the message
+	 * @return The input latency histogram
+	 */
+	const FDialogueLatencyHistogram& GetInputLatency() const;
+
+	/**
+	 * @brief Remove all the recorded input latencies
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void ResetInputLatency();
+
+	/**
+	 * @brief Log the percentiles of the recorded input latencies
+	 * @param BudgetMilliseconds The latency budget in milliseconds. The fraction of inputs over the budget is logged
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void LogInputLatency(float BudgetMilliseconds) const;
+
+	/**
+	 * @brief Register a conversation. Registering the same conversation again updates the source trigger
+	 * @param Trigger The trigger that contains the text of the conversation
+	 * @return The handle of the conversation
+	 */
+	int RegisterConversation(UDialogueTrigger* Trigger);
+
+	/**
+	 * @brief Find the handle of the specified conversation
+	 * @param ConversationId The stable ID of the conversation
+	 * @return The handle of the conversation or -1 if the conversation is not registered
+	 */
+	int FindConversation(FName ConversationId) const;
+
+	/**
+	 * @brief Get the trigger that contains the text of the specified conversation
+	 * @param Conversation The handle of the conversation
+	 * @return The trigger or nullptr if the trigger is not loaded
+	 */
+	UDialogueTrigger* GetConversationSource(int Conversation) const;
+
+	/**
+	 * @brief Get the ID used to identify the specified conversation in the telemetry
+	 * @param Conversation The handle of the conversation
+	 * @return The telemetry ID or 0 if the conversation is not registered
+	 */
+	uint32 GetTelemetryId(int Conversation) const;
+
+	/**
+	 * @brief Get the title of the specified line
+	 * @param Conversation The handle of the conversation
+	 * @param Line The index of the line
+	 * @return The title of the line or empty text if the line is not loaded
+	 */
+	FText GetLineTitle(int Conversation, int Line) const;
+
+	/**
+	 * @brief Get the message of the specified line
+	 * @param Conversation The handle of the conversation
+	 * @param Line The index of the line
+	 * @return The message of the line or empty text if the line is not loaded
+	 */
+	FText GetLineMessage(int Conversation, int Line) const;
+
+	/**
+	 * @brief Add a line to the dialogue history. The oldest line is removed when the history is full
+	 * @param Conversation The handle of the conversation
+	 * @param Line The index of the line
+	 */
+	void AddToHistory(int Conversation, int Line);
+
+	/**
+	 * @brief Change the maximum number of lines stored in the history. The current history is cleared
+	 * @param Capacity The maximum number of lines stored in the history
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void SetHistoryCapacity(int Capacity);
+
+	/**
+	 * @brief Remove all the lines from the history
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void ClearHistory();
+
+	/**
+	 * @brief Get the number of lines in the history
+	 * @return The number of lines in the history
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	int GetHistoryNum() const;
+
+	/**
+	 * @brief Get a line from the history
+	 * @param Index The index of the line. Index 0 is the oldest line in the history
+	 * @return The line at the specified index
+	 */
+	const FDialogueHistoryEntry& GetHistoryEntry(int Index) const;
+
+	/**
+	 * @brief Mark the specified line as seen
+	 * @param Conversation The handle of the conversation
+	 * @param Line The index of the line
+	 */
+	void MarkLineSeen(int Conversation, int Line);
+
+	/**
+	 * @brief Check if the specified line was seen. The line is looked up in the seen-line bitset in constant time
+	 * @param Conversation The handle of the conversation
+	 * @param Line The index of the line
+	 * @return A boolean value indicating if the line was seen
+	 */
+	bool IsLineSeen(int Conversation, int Line) const;
+
+	/**
+	 * @brief Check if the specified line was seen
+	 * @param ConversationId The stable ID of the conversation
+	 * @param Line The index of the line
+	 * @return A boolean value indicating if the line was seen
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	bool HasSeenLine(FName ConversationId, int Line) const;
+
+	/**
+	 * @brief Get the number of lines tracked by the seen-line bitset
+	 * @return The number of lines tracked by the seen-line bitset
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	int GetTrackedLineNum() const;
+
+	/**
+	 * @brief Update the conversation that is currently shown in the dialogue widget
+	 * @param Widget The dialogue widget showing the conversation
+	 * @param Conversation The handle of the conversation
+	 * @param Line The index of the current line
+	 */
+	void SetActiveLine(UDialogueWidget* Widget, int Conversation, int Line);
+
+	/**
+	 * @brief Clear the active conversation after the dialogue widget is dismissed
+	 */
+	void ClearActiveLine();
+
+	/**
+	 * @brief Get the conversation that is currently shown or was restored by the last load
+	 * @return The active conversation
+	 */
+	FDialogueActiveState GetActiveState() const;
+
+	/**
+	 * @brief Set the value of a dialogue variable
+	 * @param Name The name of the variable
+	 * @param Value The new value of the variable
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void SetDialogueVariable(FName Name, int Value);
+
+	/**
+	 * @brief Get the value of a dialogue variable
+	 * @param Name The name of the variable
+	 * @return The value of the variable or 0 if the variable is not set
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	int GetDialogueVariable(FName Name) const;
+
+	/**
+	 * @brief Save the dialogue state using a compact binary format
+	 * @param OutData The saved data
+	 * @param Incremental Only save the state that changed since the last save?
+	 * @return A boolean value indicating if the state was saved
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	bool SaveDialogueState(TArray<uint8>& OutData, bool Incremental);
+
+	/**
+	 * @brief Load the dialogue state. A full save replaces the current state and an incremental save is applied on top
+	 * @param Data The saved data
+	 * @return A boolean value indicating if the state was loaded
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	bool LoadDialogueState(const TArray<uint8>& Data);
+
+private:
+	/**
+	 * @brief The dialogue manager of the current world. Cached so streamed triggers don't need to search the world
+	 */
+	TWeakObjectPtr<ADialogueManager> CachedDialogueManager;
+
+	/**
+	 * @brief Requests lines from line providers ahead of time and caches the results across conversations
+	 */
+	FDialogueLinePrefetcher LinePrefetcher;
+
+	/**
+	 * @brief The time between a skip input and the first visible change of the message
+	 */
+	FDialogueLatencyHistogram InputLatency;
+
+	/**
+	 * @brief The time in seconds when the current frame started
+	 */
+	double FrameStartTime = 0.0;
+
+	/**
+	 * @brief The handle of the begin frame delegate
+	 */
+	FDelegateHandle BeginFrameHandle;
+
+	/**
+	 * @brief All the conversations known by the subsystem. The index is used as the conversation handle
+	 */
+	TArray<FDialogueConversation> Conversations;
+
+	/**
+	 * @brief Used to find the handle of a conversation using the stable ID
+	 */
+	TMap<FName, int> ConversationLookup;
+
+	/**
+	 * @brief The lines that were shown to the player
+	 */
+	TDialogueRingBuffer<FDialogueHistoryEntry> History;
+
+	/**
+	 * @brief One bit per registered line indicating if the line was seen
+	 */
+	FDialogueLineBitset SeenLines;
+
+	/**
+	 * @brief The values of all the dialogue variables
+	 */
+	TMap<FName, int> Variables;
+
+	/**
+	 * @brief The names of the variables that changed since the last save
+	 */
+	TSet<FName> DirtyVariables;
+
+	/**
+	 * @brief The conversation that is currently shown or was restored by the last load
+	 */
+	FDialogueActiveState ActiveState;
+
+	/**
+	 * @brief The dialogue widget showing the active conversation. Used to read the reveal progress when saving
+	 */
+	TWeakObjectPtr<UDialogueWidget> ActiveWidget;
+
+	/**
+	 * @brief Boolean value indicating if the active conversation changed since the last save
+	 */
+	bool ActiveStateDirty = false;
+
+	/**
+	 * @brief Add a conversation and reserve its lines in the seen-line bitset
+	 * @param ConversationId The stable ID of the conversation
+	 * @param LineCount The number of lines in the conversation
+	 * @return The handle of the conversation
+	 */
+	int AddConversation(FName ConversationId, int LineCount);
+
+	/**
+	 * @brief Set the telemetry ID of a conversation from its stable ID and register the name with the telemetry
+	 * @param Conversation The conversation to update
+	 */
+	static void RegisterTelemetryId(FDialogueConversation& Conversation);
+
+	/**
+	 * @brief Store the time when the frame started
+	 */
+	void OnBeginFrame();
+
+	/**
+	 * @brief Move a conversation to a larger range in the seen-line bitset and keep the seen lines
+	 * @param Conversation The handle of the conversation
+	 * @param LineCount The new number of lines in the conversation
+	 */
+	void GrowConversation(int Conversation, int LineCount);
+
+	/**
+	 * @brief Serialize the sections of the dialogue state
+	 * @param Ar The archive used to write the state
+	 * @param Incremental Only write the state that changed since the last save?
+	 */
+	void WriteState(FArchive& Ar, bool Incremental);
+
+	/**
+	 * @brief Deserialize the sections of the dialogue state
+	 * @param Ar The archive used to read the state
+	 * @return A boolean value indicating if the state was read without errors
+	 */
+	bool ReadState(FArchive& Ar);
+
+	/**
+	 * @brief Forget all the changes after the state was saved or loaded
+	 */
+	void ClearDirtyState();
+};
\ No newline at end of file
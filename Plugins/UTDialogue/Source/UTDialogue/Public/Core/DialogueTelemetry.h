@@ -0,0 +1,277 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LockFreeList.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/Event.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+class FRunnableThread;
+
+/**
+ * @brief The events recorded by the dialogue telemetry
+ */
+enum class EDialogueTelemetryEvent : uint8
+{
+	ConversationStarted = 0,
+	ConversationEnded = 1,
+	LineShown = 2,
+	LineSkipped = 3,
+	LineRevealed = 4,
+	LineExited = 5,
+	ChoiceSelected = 6
+};
+
+/**
+ * @brief A single telemetry event. Records have a fixed size so they are copied to the log without serialization
+ */
+struct FDialogueTelemetryRecord
+{
+	/**
+	 * @brief The time of the event in milliseconds since the telemetry was started
+	 */
+	uint32 Time;
+
+	/**
+	 * @brief The CRC of the stable ID of the conversation or 0 if the conversation is not registered
+	 */
+	uint32 Conversation;
+
+	/**
+	 * @brief The index of the line in the conversation
+	 */
+	uint16 Line;
+
+	/**
+	 * @brief The type of the event
+	 */
+	EDialogueTelemetryEvent Event;
+
+	/**
+	 * @brief Reserved for future use
+	 */
+	uint8 Reserved;
+
+	/**
+	 * @brief The value of the event. The number of revealed characters when a line is skipped, the time in
+	 * milliseconds spent on a line when it is revealed or exited and the index of a selected choice
+	 */
+	uint32 Value;
+};
+
+static_assert(sizeof(FDialogueTelemetryRecord) == 16, "Dialogue telemetry records must be 16 bytes");
+
+struct FDialogueTelemetryChunk;
+
+/**
+ * @brief Records dialogue events into per-thread buffers without locks. Full buffers are written to a compact binary
+ * log by a background thread. Buffers that are not full are published when the thread calls FlushThread
+ */
+class UTDIALOGUE_API FDialogueTelemetry final : public FRunnable
+{
+public:
+	/**
+	 * @brief Get the telemetry shared by the whole process
+	 * @return The telemetry
+	 */
+	static FDialogueTelemetry& Get();
+
+	/**
+	 * @brief Release the buffers. The telemetry must be stopped before, usually when the module shuts down
+	 */
+	virtual ~FDialogueTelemetry() override;
+
+	/**
+	 * @brief Start writing the recorded events to a new log file
+	 * @param Path The path of the log file. A file in the Saved/Telemetry directory is used when empty
+	 * @return A boolean value indicating if the telemetry was started
+	 */
+	bool Start(const FString& Path = FString());
+
+	/**
+	 * @brief Publish the events of the calling thread, write all the published events and close the log file
+	 */
+	void Stop();
+
+	/**
+	 * @brief Check if the recorded events are written to a log file
+	 * @return A boolean value indicating if the telemetry is running
+	 */
+	bool IsRunning() const
+	{
+		return Running.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Get the path of the current log file
+	 * @return The path of the log file or an empty string if the telemetry is not running
+	 */
+	FString GetPath();
+
+	/**
+	 * @brief Record an event in the buffer of the calling thread. Does nothing when the telemetry is not running
+	 * @param Event The type of the event
+	 * @param Conversation The CRC of the stable ID of the conversation
+	 * @param Line The index of the line
+	 * @param Value The value of the event
+	 */
+	void Record(EDialogueTelemetryEvent Event, uint32 Conversation, int Line, uint32 Value = 0);
+
+	/**
+	 * @brief Publish the buffer of the calling thread so the background thread writes it, even if it is not full
+	 */
+	void FlushThread();
+
+	/**
+	 * @brief Store the name of a conversation so the log can be converted without the game data
+	 * @param Conversation The CRC of the stable ID of the conversation
+	 * @param Name The stable ID of the conversation
+	 */
+	void RegisterName(uint32 Conversation, const FString& Name);
+
+	/**
+	 * @brief Read a telemetry log
+	 * @param Path The path of the log file
+	 * @param OutRecords The events in the log
+	 * @param OutNames The names of the conversations in the log
+	 * @return A boolean value indicating if the log was read without errors
+	 */
+	static bool ReadLog(const FString& Path, TArray<FDialogueTelemetryRecord>& OutRecords,
+		TMap<uint32, FString>& OutNames);
+
+	/**
+	 * @brief Get the name of an event
+	 * @param Event The type of the event
+	 * @return The name of the event
+	 */
+	static const TCHAR* GetEventName(EDialogueTelemetryEvent Event);
+
+	/**
+	 * @brief Measure the time spent on the calling thread to record an event and log the result
+	 * @param NumEvents The number of events to record
+	 */
+	static void RunRecordBenchmark(int NumEvents);
+
+protected:
+	/**
+	 * @brief Write the published buffers until the telemetry is stopped
+	 * @return The exit code of the thread
+	 */
+	virtual uint32 Run() override;
+
+private:
+	/**
+	 * @brief Boolean value indicating if events are recorded
+	 */
+	std::atomic<bool> Running{false};
+
+	/**
+	 * @brief Boolean value indicating if the background thread should write the last buffers and exit
+	 */
+	std::atomic<bool> StopRequested{false};
+
+	/**
+	 * @brief The number of threads inside Record or FlushThread. Stop waits for them before writing the last buffers
+	 */
+	std::atomic<int> ActiveRecorders{0};
+
+	/**
+	 * @brief Incremented every time the telemetry is started
+	 */
+	std::atomic<uint32> Session{0};
+
+	/**
+	 * @brief The cycle counter when the telemetry was started
+	 */
+	uint64 StartCycles = 0;
+
+	/**
+	 * @brief The number of milliseconds per cycle
+	 */
+	double MillisecondsPerCycle = 0.0;
+
+	/**
+	 * @brief The buffers that are full or were flushed and wait to be written
+	 */
+	TLockFreePointerListUnordered<FDialogueTelemetryChunk, PLATFORM_CACHE_LINE_SIZE> PublishedChunks;
+
+	/**
+	 * @brief The buffers that were written and can be reused
+	 */
+	TLockFreePointerListUnordered<FDialogueTelemetryChunk, PLATFORM_CACHE_LINE_SIZE> FreeChunks;
+
+	/**
+	 * @brief All the buffers that were allocated. Buffers are only released when the process exits. A lock-free list,
+	 * so a recording thread that allocates a buffer never waits for the background thread
+	 */
+	TLockFreePointerListUnordered<FDialogueTelemetryChunk, PLATFORM_CACHE_LINE_SIZE> AllChunks;
+
+	/**
+	 * @brief The number of buffers that were allocated
+	 */
+	std::atomic<int> NumChunks{0};
+
+	/**
+	 * @brief Protects the names and the path of the log file. Never held while the log file is written
+	 */
+	FCriticalSection Mutex;
+
+	/**
+	 * @brief Serializes Start and Stop. Separate from the mutex used by the background thread, which Stop waits for
+	 */
+	FCriticalSection SessionMutex;
+
+	/**
+	 * @brief The names of all the registered conversations
+	 */
+	TArray<TPair<uint32, FString>> Names;
+
+	/**
+	 * @brief The CRCs of all the registered conversations. Used to register every name once
+	 */
+	TSet<uint32> NameIds;
+
+	/**
+	 * @brief The number of names already written to the log file
+	 */
+	int WrittenNames = 0;
+
+	/**
+	 * @brief The log file
+	 */
+	FArchive* Writer = nullptr;
+
+	/**
+	 * @brief The path of the log file
+	 */
+	FString LogPath;
+
+	/**
+	 * @brief The background thread that writes the buffers
+	 */
+	FRunnableThread* Thread = nullptr;
+
+	/**
+	 * @brief Wakes the background thread when a buffer is published. Lives as long as the telemetry, so a thread that
+	 * is still recording while the telemetry stops never triggers a released event
+	 */
+	FEventRef WakeEvent{EEventMode::AutoReset};
+
+	/**
+	 * @brief Get a free buffer or allocate a new buffer
+	 * @return The buffer
+	 */
+	FDialogueTelemetryChunk* AcquireChunk();
+
+	/**
+	 * @brief Allocate a new buffer and track it so it is released with the telemetry
+	 * @return The buffer
+	 */
+	FDialogueTelemetryChunk* AllocateChunk();
+
+	/**
+	 * @brief Write the new names and all the published buffers to the log file
+	 */
+	void WritePublishedChunks();
+};
\ No newline at end of file
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/IUserObjectListEntry.h"
+#include "Blueprint/UserWidget.h"
+#include "DialogueBacklogEntryWidget.generated.h"
+
+/**
+ * @brief A widget that displays a single line in the dialogue backlog
+ */
+UCLASS()
+class UTDIALOGUE_API UDialogueBacklogEntryWidget : public UUserWidget, public IUserObjectListEntry
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief Used to display the title of the line
+	 */
+	UPROPERTY(meta = (BindWidget), EditAnywhere, BlueprintReadWrite, Category = "UI")
+	class UTextBlock* TitleText;
+
+	/**
+	 * @brief Used to display the message of the line
+	 */
+	UPROPERTY(meta = (BindWidget), EditAnywhere, BlueprintReadWrite, Category = "UI")
+	class UTextBlock* MessageText;
+
+protected:
+	/**
+	 * @brief Called when the list view assigns an item to this entry widget
+	 * @param ListItemObject The item assigned to this entry widget
+	 */
+	virtual void NativeOnListItemObjectSet(UObject* ListItemObject) override;
+};
\ No newline at end of file
@@ -0,0 +1,20 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/DialogueSubsystem.h"
+#include "DialogueBacklogItem.generated.h"
+
+/**
+ * @brief The list item used by the dialogue backlog widget. Items are pooled and only store the IDs of a line
+ */
+UCLASS()
+class UTDIALOGUE_API UDialogueBacklogItem final : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief The line displayed by this item
+	 */
+	FDialogueHistoryEntry Entry;
+};
\ No newline at end of file
@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "UI/DialogueBacklogItem.h"
+#include "DialogueBacklogWidget.generated.h"
+
+/**
+ * @brief A widget that displays the dialogue history using a virtualized list view
+ */
+UCLASS()
+class UTDIALOGUE_API UDialogueBacklogWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief The list view used to display the lines. The entry widget class should be a dialogue backlog entry widget
+	 */
+	UPROPERTY(meta = (BindWidget), EditAnywhere, BlueprintReadWrite, Category = "UI")
+	class UListView* EntryList;
+
+	/**
+	 * @brief Show the backlog widget and scroll to the latest line
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void ShowBacklog();
+
+	/**
+	 * @brief Hide the backlog widget
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void HideBacklog();
+
+	/**
+	 * @brief Update the list view using the current dialogue history
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void Refresh();
+
+protected:
+	/**
+	 * @brief Overridable native event for when the widget has been constructed
+	 */
+	virtual void NativeConstruct() override;
+
+	/**
+	 * @brief Overridable native event for when the widget is being destroyed
+	 */
+	virtual void NativeDestruct() override;
+
+private:
+	/**
+	 * @brief The items used by the list view. Items are reused and the pool never grows beyond the history capacity
+	 */
+	UPROPERTY()
+	TArray<UDialogueBacklogItem*> ItemPool;
+
+	/**
+	 * @brief The items currently assigned to the list view
+	 */
+	UPROPERTY()
+	TArray<UObject*> VisibleItems;
+
+	/**
+	 * @brief Display the visible lines in the new culture
+	 */
+	void OnCultureChanged();
+};
\ No newline at end of file
@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "DialogueBarkWidget.generated.h"
+
+/**
+ * @brief A world-space widget that displays the subtitle of an ambient bark
+ */
+UCLASS()
+class UTDIALOGUE_API UDialogueBarkWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief Used to display the message of the bark
+	 */
+	UPROPERTY(meta = (BindWidget), EditAnywhere, BlueprintReadWrite, Category = "UI")
+	class UTextBlock* BarkText;
+
+	/**
+	 * @brief Show the bark widget using the specified message
+	 * @param Message The message to display
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void ShowBark(const FText& Message);
+
+	/**
+	 * @brief Hide the bark widget
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void HideBark();
+};
\ No newline at end of file
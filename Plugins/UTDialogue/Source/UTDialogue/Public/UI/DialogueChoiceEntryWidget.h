@@ -0,0 +1,34 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/IUserObjectListEntry.h"
+#include "Blueprint/UserWidget.h"
+#include "DialogueChoiceEntryWidget.generated.h"
+
+/**
+ * @brief A widget that displays a single choice in the dialogue choice menu
+ */
+UCLASS()
+class UTDIALOGUE_API UDialogueChoiceEntryWidget : public UUserWidget, public IUserObjectListEntry
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief Used to display the text of the choice
+	 */
+	UPROPERTY(meta = (BindWidget), EditAnywhere, BlueprintReadWrite, Category = "UI")
+	class UTextBlock* ChoiceText;
+
+	/**
+	 * @brief Display the text of the assigned item again after the item was reused for another choice
+	 */
+	void RefreshChoice();
+
+protected:
+	/**
+	 * @brief Called when the list view assigns an item to this entry widget
+	 * @param ListItemObject The item assigned to this entry widget
+	 */
+	virtual void NativeOnListItemObjectSet(UObject* ListItemObject) override;
+};
\ No newline at end of file
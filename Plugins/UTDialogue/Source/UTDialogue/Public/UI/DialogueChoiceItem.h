@@ -0,0 +1,24 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "DialogueChoiceItem.generated.h"
+
+/**
+ * @brief The list item used by the dialogue choice widget. Items are pooled and reused for every choice menu
+ */
+UCLASS()
+class UTDIALOGUE_API UDialogueChoiceItem final : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief The index of the choice in the current choice menu
+	 */
+	int ChoiceIndex = INDEX_NONE;
+
+	/**
+	 * @brief The text of the choice
+	 */
+	FText Text;
+};
\ No newline at end of file
@@ -0,0 +1,101 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "Core/DialogueChoice.h"
+#include "UI/DialogueChoiceItem.h"
+#include "DialogueChoiceWidget.generated.h"
+
+/**
+ * @brief A widget that displays the player responses using a virtualized list view. The list items and the entry
+ * widgets are pooled, so showing a choice menu never creates or destroys widgets after the first menu
+ */
+UCLASS()
+class UTDIALOGUE_API UDialogueChoiceWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * @brief The list view used to display the choices. The entry widget class should be a dialogue choice entry widget
+	 */
+	UPROPERTY(meta = (BindWidget), EditAnywhere, BlueprintReadWrite, Category = "UI")
+	class UListView* ChoiceList;
+
+	/**
+	 * @brief Show the choice menu, select the first choice and focus the list for keyboard and gamepad navigation
+	 * @param Choices The choices to display
+	 */
+	void ShowChoices(const TArray<FDialogueChoice>& Choices);
+
+	/**
+	 * @brief Hide the choice menu
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void HideChoices();
+
+	/**
+	 * @brief Check if the choice menu is currently shown
+	 * @return A boolean value indicating if the choice menu is currently shown
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	bool IsShowingChoices() const;
+
+	/**
+	 * @brief Move the selection by the specified number of choices. The selection wraps around
+	 * @param Offset The number of choices to move. Negative values move up
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void NavigateChoices(int Offset);
+
+	/**
+	 * @brief Get the index of the selected choice
+	 * @return The index of the selected choice or -1 if no choice is selected
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	int GetSelectedChoice() const;
+
+protected:
+	/**
+	 * @brief Overridable native event for when the widget has been constructed
+	 */
+	virtual void NativeConstruct() override;
+
+	/**
+	 * @brief Overridable native event for when the widget is being destroyed
+	 */
+	virtual void NativeDestruct() override;
+
+	/**
+	 * @brief Called when a key is pressed while the choice menu has focus. The accept key picks the selected choice
+	 * @param InGeometry The geometry of the widget
+	 * @param InKeyEvent The key event
+	 * @return The reply indicating if the event was handled
+	 */
+	virtual FReply NativeOnKeyDown(const FGeometry& InGeometry, const FKeyEvent& InKeyEvent) override;
+
+private:
+	/**
+	 * @brief The items used by the list view. Items are reused and the pool only grows for a larger menu
+	 */
+	UPROPERTY()
+	TArray<UDialogueChoiceItem*> ItemPool;
+
+	/**
+	 * @brief The items currently assigned to the list view
+	 */
+	UPROPERTY()
+	TArray<UObject*> VisibleItems;
+
+	/**
+	 * @brief Called when a choice is clicked
+	 * @param Item The item of the clicked choice
+	 */
+	void OnChoiceClicked(UObject* Item);
+
+	/**
+	 * @brief Pick the specified choice using the dialogue manager
+	 * @param ChoiceIndex The index of the choice
+	 */
+	void ConfirmChoice(int ChoiceIndex) const;
+};
\ No newline at end of file
@@ -61,6 +61,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
 	void HideWidget(bool Animated);
 
+	/**
+	 * @brief Check if the hide animation is playing
+	 * @return A boolean value indicating if the hide animation is playing
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	bool IsHiding() const;
+
 protected:
 	/**
 	 * @brief Overridable native event for when the widget has been constructed
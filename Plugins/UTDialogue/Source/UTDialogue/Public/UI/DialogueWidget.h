@@ -3,8 +3,116 @@
 #include "CoreMinimal.h"
 #include "Blueprint/UserWidget.h"
 #include "Audio/DialogueVoiceList.h"
+#include "Audio/DialogueVoiceSelector.h"
+#include "Core/DialogueChoice.h"
+#include "Core/DialogueCue.h"
+#include "Core/DialoguePreparedConversation.h"
+#include "Core/DialogueTelemetry.h"
+#include "UI/DialogueInteractWidget.h"
 #include "DialogueWidget.generated.h"
 
+class UDialogueChoiceWidget;
+class UDialogueTrigger;
+class UQuartzClockHandle;
+class USoundWave;
+
+/**
+ * @brief The mode used to reveal the text of a message
+ */
+UENUM(BlueprintType)
+enum class EDialogueTypingMode : uint8
+{
+	FixedRate UMETA(DisplayName = "Fixed rate"),
+	VoiceDuration UMETA(DisplayName = "Voice duration")
+};
+
+/**
+ * @brief The replay state of a dialogue widget
+ */
+UENUM(BlueprintType)
+enum class EDialogueReplayState : uint8
+{
+	None UMETA(DisplayName = "None"),
+	Recording UMETA(DisplayName = "Recording"),
+	Replaying UMETA(DisplayName = "Replaying")
+};
+
+/**
+ * @brief The recorded input of a dialogue session. Replaying it produces the same voice files and the same timing
+ */
+USTRUCT(BlueprintType)
+struct FDialogueReplay
+{
+	GENERATED_BODY()
+
+	/**
+	 * @brief The seed used to select the voice files
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Replay")
+	int Seed = 0;
+
+	/**
+	 * @brief The time step in seconds used to replay the frames after the recorded frames
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Replay")
+	float TimeStep = 1.0f / 60.0f;
+
+	/**
+	 * @brief The time in seconds of every frame while recording
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Replay")
+	TArray<float> FrameTimes;
+
+	/**
+	 * @brief The dialogue time in seconds of every skip input
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Replay")
+	TArray<float> SkipTimes;
+
+	/**
+	 * @brief The stable ID of the first conversation shown while recording
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Replay")
+	FName ConversationId;
+
+	/**
+	 * @brief The dialogue time in seconds when the first conversation was shown or a negative value if no conversation
+	 * was shown while recording
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Replay")
+	float ConversationStartTime = -1.0f;
+
+	/**
+	 * @brief The lines of the first conversation that were already seen when it was shown
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Replay")
+	TArray<bool> SeenLines;
+};
+
+/**
+ * @brief Data derived from the text of a line. Rebuilt when the line changes or the culture changes
+ */
+struct FDialogueLineCache
+{
+	/**
+	 * @brief The message of the line in the current culture
+	 */
+	FString Message;
+
+	/**
+	 * @brief Boolean value indicating if the data must be rebuilt before it is used
+	 */
+	bool Stale = true;
+};
+
+/**
+ * @brief Called when the typing animation reaches one or more cues. All the cues reached in the same frame are
+ * passed together
+ * @param Line The index of the line
+ * @param Cues The cues that were reached in the order of the cue track
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnDialogueCues, int, Line, const TArray<FDialogueCue>&, Cues);
+
 /**
  * @brief A widget that is displays the dialogue entry's title and text
  */
@@ -26,12 +134,110 @@ public:
 	UPROPERTY(meta = (BindWidget), EditAnywhere, BlueprintReadWrite, Category = "UI")
 	class UTextBlock* MessageText;
 
+	/**
+	 * @brief Used to display the player responses after a line with choices
+	 */
+	UPROPERTY(meta = (BindWidgetOptional), EditAnywhere, BlueprintReadWrite, Category = "UI")
+	UDialogueChoiceWidget* ChoiceWidget;
+
+	/**
+	 * @brief Called when the typing animation reaches the cues of the current line
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Dialogue|Cues")
+	FOnDialogueCues OnDialogueCues;
+
 	/**
 	 * @brief Sound that is played when showing the widget or when skipping a message
 	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue")
 	USoundBase* InteractSound;
 
+	/**
+	 * @brief The mode used to reveal the text of a message
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Typing")
+	EDialogueTypingMode TypingMode;
+
+	/**
+	 * @brief The time in seconds between two characters when using the fixed rate typing mode
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Typing", meta = (ClampMin = "0.001"))
+	float TypingInterval = 0.05f;
+
+	/**
+	 * @brief Should the next voiced line start automatically after the voice file of the current line is finished?
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Typing")
+	bool VoiceAutoAdvance = true;
+
+	/**
+	 * @brief The silence in seconds between two voiced lines when advancing automatically
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Typing", meta = (ClampMin = "0.0"))
+	float VoiceLineGap = 0.25f;
+
+	/**
+	 * @brief The seed used to select voice files. 0 uses a different seed every time the widget is constructed
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Voice")
+	int VoiceSeed;
+
+	/**
+	 * @brief The time step in seconds used to replay the frames after the recorded frames
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Replay", meta = (ClampMin = "0.001"))
+	float ReplayTimeStep = 1.0f / 60.0f;
+
+	/**
+	 * @brief The maximum time in seconds to wait for a line provider before the static message is shown
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Provider", meta = (ClampMin = "0.0"))
+	float ProviderTimeout = 0.5f;
+
+	/**
+	 * @brief Should lines that were already seen be typed at the fast-forward rate and advanced automatically?
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Fast Forward")
+	bool SkipSeenLines;
+
+	/**
+	 * @brief Should the next line be shown automatically after the current line is fully revealed?
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Fast Forward")
+	bool AutoAdvance;
+
+	/**
+	 * @brief The number of characters revealed per second when fast-forwarding through a seen line
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Fast Forward", meta = (ClampMin = "1.0"))
+	float FastForwardCharactersPerSecond = 200.0f;
+
+	/**
+	 * @brief The time in seconds before advancing after a seen line is fully revealed while fast-forwarding
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Fast Forward", meta = (ClampMin = "0.0"))
+	float FastForwardAdvanceDelay = 0.1f;
+
+	/**
+	 * @brief The time in seconds before advancing after a line is fully revealed when auto-advance is enabled
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Fast Forward", meta = (ClampMin = "0.0"))
+	float AutoAdvanceDelay = 1.5f;
+
+	/**
+	 * @brief The time in seconds a skip input is kept when it can't be applied yet, for example on the frame the widget
+	 * is shown, while the interact widget plays its hide animation or when another input was already applied in the
+	 * same frame
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Input", meta = (ClampMin = "0.0"))
+	float InputBufferWindow = 0.2f;
+
+	/**
+	 * @brief Skip inputs closer than this time in seconds to the previous input or to showing the widget are ignored
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dialogue|Input", meta = (ClampMin = "0.0"))
+	float InputDebounceTime = 0.08f;
+
 	/**
 	 * @brief Show the Dialogue Widget by using the specified information
 	 * @param NewTitles The array of titles to display
@@ -39,20 +245,137 @@ public:
 	 * @param NewVoices The array of voice files to play
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
-	void Show(TArray<FText> NewTitles, TArray<FText> NewMessages, TArray<TSubclassOf<UDialogueVoiceList>> NewVoices);
+	void Show(const TArray<FText>& NewTitles, const TArray<FText>& NewMessages,
+		const TArray<TSubclassOf<UDialogueVoiceList>>& NewVoices);
 
 	/**
-	 * @brief Skip the type animation or continue to the next message in the list
+	 * @brief Show the Dialogue Widget for a registered conversation. The lines are added to the dialogue history
+	 * @param NewConversation The handle of the conversation in the dialogue subsystem
+	 * @param NewTitles The array of titles to display
+	 * @param NewMessages The array of messages to display
+	 * @param NewVoices The array of voice files to play
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void ShowConversation(int NewConversation, const TArray<FText>& NewTitles, const TArray<FText>& NewMessages,
+		const TArray<TSubclassOf<UDialogueVoiceList>>& NewVoices);
+
+	/**
+	 * @brief Show the Dialogue Widget for a conversation that was prepared ahead of time. The prepared text is shared
+	 * and not processed again, so the cost does not depend on the number of lines
+	 * @param NewConversation The handle of the conversation in the dialogue subsystem
+	 * @param NewPrepared The prepared text of the conversation
+	 * @param NewVoices The array of voice files to play
+	 */
+	void ShowPrepared(int NewConversation,
+		const TSharedRef<const FDialoguePreparedConversation, ESPMode::ThreadSafe>& NewPrepared,
+		const TArray<TSubclassOf<UDialogueVoiceList>>& NewVoices);
+
+	/**
+	 * @brief Restore a conversation after loading a save. No sounds are played and the line is not added to the history
+	 * @param NewConversation The handle of the conversation in the dialogue subsystem
+	 * @param NewPrepared The prepared text of the conversation
+	 * @param NewVoices The array of voice files to play
+	 * @param Line The index of the line to display
+	 * @param RevealedCharacters The number of characters already revealed or -1 if the line was fully revealed
+	 * @return A boolean value indicating if the conversation was restored
+	 */
+	bool RestoreConversation(int NewConversation,
+		const TSharedRef<const FDialoguePreparedConversation, ESPMode::ThreadSafe>& NewPrepared,
+		const TArray<TSubclassOf<UDialogueVoiceList>>& NewVoices, int Line, int RevealedCharacters);
+
+	/**
+	 * @brief Get the number of characters revealed by the typing animation
+	 * @return The number of characters revealed or -1 if the current line is fully revealed
+	 */
+	int GetRevealedCharacters() const;
+
+	/**
+	 * @brief Get the number of characters of the current line that are visible
+	 * @return The number of visible characters. The length of the message when the line is fully revealed
+	 */
+	UFUNCTION(BlueprintPure, Category = "Unreal Toolbox|Dialogue")
+	int GetTypingIndex() const;
+
+	/**
+	 * @brief Skip the type animation or continue to the next message in the list. The input is buffered when it can't
+	 * be applied in the current frame and repeated inputs are ignored. Ignored while replaying
 	 * @return A boolean value indicating if the last message was skipped
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
 	bool SkipMessage();
 
+	/**
+	 * @brief Pick a choice of the current line and continue to the next line of the choice
+	 * @param ChoiceIndex The index of the choice
+	 * @return A boolean value indicating if the choice ended the conversation
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	bool SelectChoice(int ChoiceIndex);
+
+	/**
+	 * @brief Move the selection in the choice menu by the specified number of choices
+	 * @param Offset The number of choices to move. Negative values move up
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void NavigateChoices(int Offset);
+
+	/**
+	 * @brief Check if the choice menu of the current line is shown
+	 * @return A boolean value indicating if the choice menu is shown
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	bool IsShowingChoices() const;
+
+	/**
+	 * @brief Change the seed used to select voice files. The selection history is cleared
+	 * @param Seed The new seed. 0 uses a different seed every time
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void SetVoiceSeed(int Seed);
+
+	/**
+	 * @brief Start recording the skip inputs. The voice selection is reset so the recording can be replayed
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void StartRecording();
+
+	/**
+	 * @brief Stop recording the skip inputs
+	 * @return The recorded input
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	FDialogueReplay StopRecording();
+
+	/**
+	 * @brief Replay recorded input. Live skip inputs are ignored until the replay is stopped
+	 * @param NewReplay The recorded input
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void StartReplay(const FDialogueReplay& NewReplay);
+
+	/**
+	 * @brief Stop replaying recorded input
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	void StopReplay();
+
+	/**
+	 * @brief Get the replay state of the widget
+	 * @return The replay state of the widget
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Unreal Toolbox|Dialogue")
+	EDialogueReplayState GetReplayState() const;
+
 protected:
 	/**
 	 * @brief Overridable native event for when the widget has been constructed
 	 */
 	virtual void NativeConstruct() override;
+
+	/**
+	 * @brief Overridable native event for when the widget is being destroyed
+	 */
+	virtual void NativeDestruct() override;
 	
 	/**
 	 * @brief Function called every frame on this widget
@@ -61,21 +384,46 @@ protected:
 	 */
 	virtual void NativeTick(const FGeometry& MyGeometry, float InDeltaTime) override;
 
+	/**
+	 * @brief Paint the widget and record the input latency when the message changed since the last paint
+	 * @param Args The arguments of the paint pass
+	 * @param AllottedGeometry The geometry of the widget
+	 * @param MyCullingRect The culling rectangle of the widget
+	 * @param OutDrawElements The list the draw elements are added to
+	 * @param LayerId The first layer of the widget
+	 * @param InWidgetStyle The style inherited from the parent widget
+	 * @param bParentEnabled Boolean value indicating if the parent widget is enabled
+	 * @return The last layer used by the widget
+	 */
+	virtual int32 NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry,
+		const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId,
+		const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+
 private:	
 	/**
 	 * @brief The index of the current dialogue entry 
 	 */
 	int Index;
-	
+
 	/**
-	 * @brief The array of titles to display
+	 * @brief The handle of the current conversation in the dialogue subsystem or -1 if it is not registered
 	 */
-	TArray<FText> Titles;
+	int Conversation = INDEX_NONE;
 	
 	/**
-	 * @brief The array of messages to display
+	 * @brief The prepared titles, messages, choices and cues of the current conversation
 	 */
-	TArray<FText> Messages;
+	TSharedPtr<const FDialoguePreparedConversation, ESPMode::ThreadSafe> Prepared;
+
+	/**
+	 * @brief The messages received from the line provider. They replace the prepared messages
+	 */
+	TMap<int, FText> ProvidedMessages;
+
+	/**
+	 * @brief Boolean value indicating if the prepared message strings match the current culture
+	 */
+	bool PreparedStringsCurrent;
 	
 	/**
 	 * @brief The array of voice files to play
@@ -88,6 +436,165 @@ private:
 	 */
 	UPROPERTY()
 	UAudioComponent* AudioComponent;
+
+	/**
+	 * @brief The audio component used to queue the voice file of the next line in the voice duration typing mode
+	 */
+	UPROPERTY()
+	UAudioComponent* QueuedAudioComponent;
+
+	/**
+	 * @brief The audio component playing the blips. Separate from the voice files so their pitch and volume are not
+	 * changed by the blips
+	 */
+	UPROPERTY()
+	UAudioComponent* BlipAudioComponent;
+
+	/**
+	 * @brief The clock used to schedule the voice file of the next line with sample accuracy
+	 */
+	UPROPERTY()
+	UQuartzClockHandle* VoiceClock;
+
+	/**
+	 * @brief The line that will be played by the queued audio component or -1 if nothing is queued
+	 */
+	int QueuedLine = INDEX_NONE;
+
+	/**
+	 * @brief The trigger of the current conversation if it has a line provider
+	 */
+	TWeakObjectPtr<UDialogueTrigger> LineSource;
+
+
+	/**
+	 * @brief The position of the next cue of the current line in the cue order
+	 */
+	int CueCursor;
+
+	/**
+	 * @brief The indices of the cues of the current line sorted by their character offset. The cues before the cursor
+	 * already fired
+	 */
+	TArray<int> CueOrder;
+
+	/**
+	 * @brief The length of the message the cue order was sorted for or -1 if the cues were not sorted yet
+	 */
+	int CueOrderLength = INDEX_NONE;
+
+	/**
+	 * @brief The cues reached in the current frame. Reused to avoid allocating for every broadcast
+	 */
+	TArray<FDialogueCue> FiredCues;
+
+	/**
+	 * @brief The derived data of the lines that can't use the prepared message strings. Allocated on first use
+	 */
+	TArray<FDialogueLineCache> LineCache;
+
+	/**
+	 * @brief The lines waiting to be rebuilt in the background. The last line is rebuilt first
+	 */
+	TArray<int> StaleLines;
+
+	/**
+	 * @brief Boolean value indicating if the current line waits for the line provider before typing starts
+	 */
+	bool WaitingForLine;
+
+	/**
+	 * @brief The time in seconds the current line has been waiting for the line provider
+	 */
+	float LineWaitTime;
+
+	/**
+	 * @brief Boolean value indicating if the current line shows the static message until the line provider responds
+	 * in the new culture
+	 */
+	bool WaitingForCultureLine;
+
+	/**
+	 * @brief Selects the voice files using a seeded random stream
+	 */
+	FDialogueVoiceSelector VoiceSelector;
+
+	/**
+	 * @brief The index of the voice file selected for every line or -1 if no voice file was selected yet
+	 */
+	TArray<int> LineVoices;
+
+	/**
+	 * @brief The replay state of the widget
+	 */
+	EDialogueReplayState ReplayState;
+
+	/**
+	 * @brief The input that is recorded or replayed
+	 */
+	FDialogueReplay Replay;
+
+	/**
+	 * @brief The index of the next skip input to replay
+	 */
+	int ReplayCursor;
+
+	/**
+	 * @brief The index of the next recorded frame to replay
+	 */
+	int ReplayFrame;
+
+	/**
+	 * @brief The handle of the replayed conversation. Only valid when the replayed seen lines are not empty
+	 */
+	int ReplayConversation = INDEX_NONE;
+
+	/**
+	 * @brief The lines of the replayed conversation that were seen. Used instead of the dialogue subsystem while
+	 * replaying, so fast-forwarding matches the recording
+	 */
+	TArray<bool> ReplaySeenLines;
+
+	/**
+	 * @brief The time in seconds since recording or replaying started
+	 */
+	float DialogueTime;
+
+	/**
+	 * @brief The time in seconds when every character is revealed. Computed once when a voiced line starts
+	 */
+	TArray<float> RevealTimes;
+
+	/**
+	 * @brief The time in seconds since the current voiced line started
+	 */
+	float LineElapsed;
+
+	/**
+	 * @brief The duration in seconds of the voice file of the current line
+	 */
+	float LineDuration;
+
+	/**
+	 * @brief The word timing markers of the voice file of the current line or nullptr if the line has no markers
+	 */
+	const TArray<float>* LineWordTimings;
+
+	/**
+	 * @brief The playback time in seconds of the voice file reported by the audio engine since the last tick or a
+	 * negative value if no playback time was reported
+	 */
+	float VoicePlaybackTime = -1.0f;
+
+	/**
+	 * @brief Boolean value indicating if the voice files were paused because the game is paused
+	 */
+	bool VoicePaused;
+
+	/**
+	 * @brief Boolean value indicating if the widget is advancing because the voice file of the current line finished
+	 */
+	bool AdvancingFromVoice;
 	
 	/**
 	 * @brief Boolean value indicating if we're busy typing the current dialogue message
@@ -104,17 +611,374 @@ private:
 	 */
 	int TypingIndex;
 
+	/**
+	 * @brief Boolean value indicating if the current line was already seen before it was shown
+	 */
+	bool CurrentLineSeen;
+
+	/**
+	 * @brief Counter used to delay the automatic advance after a line is fully revealed
+	 */
+	float AdvanceCounter;
+
+	/**
+	 * @brief The number of letters revealed in the current line. Used to play a blip every few letters
+	 */
+	int BlipCharacters;
+
+	/**
+	 * @brief The time in seconds before the next blip can be played
+	 */
+	float BlipCooldown;
+
+	/**
+	 * @brief The time of every skip input that was not applied yet. The oldest input is first
+	 */
+	TArray<double> QueuedInputs;
+
+	/**
+	 * @brief The time of the last skip input or of showing the widget. Used to ignore repeated inputs
+	 */
+	double LastInputTime;
+
+	/**
+	 * @brief The frame when the last skip input was applied or the widget was shown
+	 */
+	uint64 LastInputFrame;
+
+	/**
+	 * @brief The last time skip inputs were held back by the hide animation of the interact widget. Buffered inputs
+	 * expire relative to this time, so the animation does not use up the buffer window
+	 */
+	double InputBlockedTime;
+
+	/**
+	 * @brief The interact widget whose hide animation holds back the skip inputs. Found when the widget is shown
+	 */
+	TWeakObjectPtr<UDialogueInteractWidget> InteractWidget;
+
+	/**
+	 * @brief The start of the frame of the applied skip input that was not painted yet or 0 if no input is measured.
+	 * Mutable because the latency is recorded while painting
+	 */
+	mutable double PendingInputTime;
+
+	/**
+	 * @brief Boolean value indicating if the message changed after the measured skip input and was not painted yet
+	 */
+	mutable bool MessageChangePending;
+
+	/**
+	 * @brief The ID of the conversation in the telemetry or 0 if the conversation is not registered
+	 */
+	uint32 TelemetryConversation;
+
+	/**
+	 * @brief The time when the current line was shown or 0 if no line is shown
+	 */
+	double LineStartTime;
+
+	/**
+	 * @brief Forget the buffered skip inputs and ignore inputs within the debounce time after showing the widget
+	 */
+	void ResetInput();
+
+	/**
+	 * @brief Check if a skip input can be applied now. Only one input is applied per frame and no input is applied on
+	 * the frame the widget is shown or while the interact widget plays its hide animation
+	 * @return A boolean value indicating if a skip input can be applied
+	 */
+	bool CanApplyInput() const;
+
+	/**
+	 * @brief Check if the interact widget plays its hide animation
+	 * @return A boolean value indicating if the interact widget is hiding
+	 */
+	bool IsInteractWidgetHiding() const;
+
+	/**
+	 * @brief Get the time of a skip input received in the current frame. The same clock is used to measure the input
+	 * latency, so the time is not taken from the application time, which a fixed time step advances by the step
+	 * @return The time in seconds when the current frame started
+	 */
+	double GetInputTime() const;
+
+	/**
+	 * @brief Apply a skip input and start measuring the time until the message changes
+	 * @param InputTime The time when the input was received
+	 * @return A boolean value indicating if the last message was skipped
+	 */
+	bool ApplyInput(double InputTime);
+
+	/**
+	 * @brief Drop the buffered skip inputs that are older than the buffer window and apply the oldest remaining input
+	 */
+	void TickInput();
+
+	/**
+	 * @brief Change the text of the message. The input latency is recorded when the change is painted
+	 * @param Text The new text of the message
+	 */
+	void SetMessageText(const FText& Text);
+
+	/**
+	 * @brief Record the time from the start of the frame of the last applied skip input until now
+	 */
+	void RecordInputLatency() const;
+
+	/**
+	 * @brief Get the prepared text of the current conversation
+	 * @return The prepared conversation or an empty conversation if no conversation was shown
+	 */
+	const FDialoguePreparedConversation& GetPrepared() const;
+
+	/**
+	 * @brief Prepare a conversation on the game thread. Used when the conversation was not prepared ahead of time
+	 * @param NewConversation The handle of the conversation in the dialogue subsystem
+	 * @param NewTitles The array of titles to display
+	 * @param NewMessages The array of messages to display
+	 * @return The prepared conversation
+	 */
+	TSharedRef<const FDialoguePreparedConversation, ESPMode::ThreadSafe> PrepareNow(int NewConversation,
+		const TArray<FText>& NewTitles, const TArray<FText>& NewMessages) const;
+
+	/**
+	 * @brief Get the message of a line. The message received from the line provider is used when available
+	 * @param Line The index of the line
+	 * @return The message of the line
+	 */
+	const FText& GetMessage(int Line) const;
+
+	/**
+	 * @brief Find the message of a line as a string without building it
+	 * @param Line The index of the line
+	 * @return The message of the line in the current culture or nullptr if the string must be built
+	 */
+	const FString* FindLineMessage(int Line) const;
+
+	/**
+	 * @brief Forget the derived data of the previous conversation. The prepared strings are used when they match the
+	 * current culture
+	 */
+	void ResetLineCache();
+
+	/**
+	 * @brief Mark the derived data of every line as stale and queue the lines to be rebuilt, starting at the current
+	 * line
+	 */
+	void InvalidateLineCache();
+
+	/**
+	 * @brief Get the message of a line as a string. The string is built if it can't be found
+	 * @param Line The index of the line
+	 * @return The message of the line in the current culture
+	 */
+	const FString& GetLineMessage(int Line);
+
+	/**
+	 * @brief Rebuild a few stale lines. Spreads the cost of a conversation or culture change over several frames
+	 */
+	void TickLineCache();
+
+	/**
+	 * @brief Rebuild the derived data and display the current line in the new culture
+	 */
+	void OnCultureChanged();
+
+	/**
+	 * @brief Display the current line again and keep the typing progress. Used after the culture changed
+	 */
+	void RefreshCurrentLine();
+
+	/**
+	 * @brief Fire the cues of the current line that were reached since the last call
+	 * @param RevealedCharacters The number of revealed characters
+	 */
+	void FireCues(int RevealedCharacters);
+
+	/**
+	 * @brief Reset the cue order of the current line. No cue of the line has fired yet
+	 */
+	void ResetCueOrder();
+
+	/**
+	 * @brief Sort the cues of the current line that did not fire yet for the length of the current message
+	 * @param MessageLength The length of the current message
+	 */
+	void SortCueOrder(int MessageLength);
+
+	/**
+	 * @brief Record a telemetry event for the current line
+	 * @param Event The type of the event
+	 * @param Value The value of the event
+	 */
+	void RecordTelemetry(EDialogueTelemetryEvent Event, uint32 Value = 0) const;
+
+	/**
+	 * @brief Get the time spent on the current line
+	 * @return The time in milliseconds since the current line was shown
+	 */
+	uint32 GetLineMilliseconds() const;
+
+	/**
+	 * @brief Skip the type animation or continue to the next message in the list
+	 * @return A boolean value indicating if the last message was skipped
+	 */
+	bool ApplySkip();
+
+	/**
+	 * @brief Apply the recorded skip inputs that happened before the current dialogue time
+	 */
+	void TickReplay();
+
+	/**
+	 * @brief Record or apply the start of the first conversation of a recording, so a replay shows the conversation at
+	 * the same dialogue time and with the same seen lines
+	 */
+	void SyncReplayConversation();
+
+	/**
+	 * @brief Get the voice file of the specified line. The voice file is selected once per line
+	 * @param Line The index of the line
+	 * @return The index of the voice file or -1 if the line has no voice files
+	 */
+	int GetLineVoice(int Line);
+
+	/**
+	 * @brief Continue to the next message in the list or dismiss the widget after the last message
+	 * @return A boolean value indicating if the last message was dismissed
+	 */
+	bool AdvanceMessage();
+
+	/**
+	 * @brief Show the choice menu if the current line has choices
+	 * @return A boolean value indicating if the choice menu is shown
+	 */
+	bool ShowLineChoices();
+
+	/**
+	 * @brief Hide the widget and notify the dialogue manager after the conversation ended
+	 */
+	void Dismiss();
+
+	/**
+	 * @brief Check if the current line is fast-forwarded
+	 * @return A boolean value indicating if the current line is fast-forwarded
+	 */
+	bool IsFastForwarding() const;
+
+	/**
+	 * @brief Check if a line of the current conversation was seen. Replays use the seen lines of the recording
+	 * @param Line The index of the line
+	 * @return A boolean value indicating if the line was seen
+	 */
+	bool WasLineSeen(int Line) const;
+
+	/**
+	 * @brief Advance automatically when auto-advance or fast-forward is active and the delay has passed
+	 * @param InDeltaTime The time since the last tick
+	 */
+	void TickAutoAdvance(float InDeltaTime);
+
 	/**
 	 * @brief Update the character index in the typing animation
 	 * @param NewIndex The new character index
 	 */
 	void UpdateIndex(int NewIndex);
+
+	/**
+	 * @brief Start the voice file of the current line once the message of the line is known
+	 */
+	void StartLine();
+
+	/**
+	 * @brief Find the trigger of the current conversation to use its line provider
+	 */
+	void ResolveLineSource();
+
+	/**
+	 * @brief Prefetch the next lines and replace the current message with the provided message if it is available
+	 * @return A boolean value indicating if the current message is known
+	 */
+	bool ApplyProvidedLine();
+
+	/**
+	 * @brief Wait for the line provider without blocking and fall back to the static message after the timeout
+	 * @param InDeltaTime The time since the last tick
+	 */
+	void TickLineProvider(float InDeltaTime);
+
+	/**
+	 * @brief Display the message the line provider returned in the new culture once it is available
+	 */
+	void TickCultureLine();
 	
 	/**
 	 * @brief Stop the typing animation and display the full message
 	 */
 	void StopTyping();
 	
+	/**
+	 * @brief Start the voice file of the current line and compute the reveal time of every character
+	 * @param RevealedCharacters The number of characters already revealed or -1 if the line was fully revealed. The
+	 * voice file starts at the time of the last revealed character
+	 */
+	void StartVoiceLine(int RevealedCharacters = 0);
+
+	/**
+	 * @brief Schedule the voice file of the next line to start after the current voice file is finished
+	 */
+	void QueueNextVoice();
+
+	/**
+	 * @brief Stop the queued voice file before it starts playing
+	 */
+	void CancelQueuedVoice();
+
+	/**
+	 * @brief Update the typing animation and automatic advance using the precomputed reveal times
+	 * @param InDeltaTime The time since the last tick
+	 */
+	void TickVoiceTyping(float InDeltaTime);
+
+	/**
+	 * @brief Play a blip for the revealed letters when the voice list of the current line uses blips. Every blip reuses
+	 * the same audio component and only changes the pitch and volume
+	 * @param Message The current message
+	 * @param FirstCharacter The index of the first character revealed since the last call
+	 */
+	void PlayBlips(const FString& Message, int FirstCharacter);
+
+	/**
+	 * @brief Compute the time when every character in the current message is revealed
+	 * @param Message The current message
+	 * @param Duration The duration of the voice file
+	 * @param WordStartTimes Optional timing markers for every word in the message
+	 */
+	void BuildRevealTimes(const FString& Message, float Duration, const TArray<float>* WordStartTimes);
+
+	/**
+	 * @brief Get an audio component that is reused for every voice file
+	 * @param Component The audio component to create if needed
+	 * @return The audio component
+	 */
+	UAudioComponent* GetOrCreateAudioComponent(UAudioComponent*& Component);
+
+	/**
+	 * @brief Get an audio component that is reused for every voice file and reports its playback time
+	 * @param Component The audio component to create if needed
+	 * @return The audio component
+	 */
+	UAudioComponent* GetOrCreateVoiceComponent(UAudioComponent*& Component);
+
+	/**
+	 * @brief Function called by the audio engine when the playback time of a voice file changed
+	 * @param Component The audio component playing the voice file
+	 * @param PlayingSoundWave The sound wave that is playing
+	 * @param Percent The playback time as a fraction of the duration of the sound wave
+	 */
+	void OnVoicePlaybackPercent(const UAudioComponent* Component, const USoundWave* PlayingSoundWave, float Percent);
+
 	/**
 	 * @brief Check if a voice file is playing
 	 * @return A boolean value indicating if a voice file is playing
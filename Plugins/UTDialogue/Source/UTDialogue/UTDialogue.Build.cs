@@ -10,7 +10,11 @@ public class UTDialogue : ModuleRules
 		PublicDependencyModuleNames.AddRange(new string[]
 			{"Core", "UMG", "Slate", "SlateCore", "UTLogger", "UTInputIndicator"});
 		PrivateDependencyModuleNames.AddRange(new string[]
-			{"CoreUObject", "Engine", "UMG", "Slate", "SlateCore", "UTLogger", "UTInputIndicator"});
+			{"CoreUObject", "Engine", "UMG", "Slate", "SlateCore", "AudioMixer", "UTLogger", "UTInputIndicator"});
 		DynamicallyLoadedModuleNames.AddRange(new string[] { });
+
+		// Dialogue data is validated by the DialogueValidation commandlet, so shipping builds skip the runtime checks
+		PublicDefinitions.Add("UTDIALOGUE_VALIDATE_RUNTIME=" +
+			(Target.Configuration == UnrealTargetConfiguration.Shipping ? "0" : "1"));
 	}
 }
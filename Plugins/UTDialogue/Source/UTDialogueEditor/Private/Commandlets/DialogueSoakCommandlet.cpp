@@ -0,0 +1,198 @@
+﻿#include "Commandlets/DialogueSoakCommandlet.h"
+#include "Blueprint/UserWidget.h"
+#include "Components/DialogueTrigger.h"
+#include "Core/DialogueManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "UI/DialogueInteractWidget.h"
+#include "UI/DialogueWidget.h"
+#include "Core/Log.h"
+
+UDialogueSoakCommandlet::UDialogueSoakCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	World = nullptr;
+	Player = nullptr;
+	DialogueManager = nullptr;
+	IndicatorClass = nullptr;
+	NumLines = 3;
+}
+
+/**
+ * @brief Run the commandlet
+ * @param Params The command line parameters
+ * @return 0 if no growth was detected or 1 if the soak test failed
+ */
+int32 UDialogueSoakCommandlet::Main(const FString& Params)
+{
+	int NumCycles = 10000;
+	int NumTriggers = 64;
+	int Interval = 1000;
+	int MaxObjectGrowth = 0;
+	float MaxMemoryGrowthMB = 16.0f;
+	FString DialogueWidgetPath;
+	FString InteractWidgetPath;
+	FString IndicatorClassPath;
+	FParse::Value(*Params, TEXT("Cycles="), NumCycles);
+	FParse::Value(*Params, TEXT("Triggers="), NumTriggers);
+	FParse::Value(*Params, TEXT("Interval="), Interval);
+	FParse::Value(*Params, TEXT("Lines="), NumLines);
+	FParse::Value(*Params, TEXT("MaxObjectGrowth="), MaxObjectGrowth);
+	FParse::Value(*Params, TEXT("MaxMemoryGrowthMB="), MaxMemoryGrowthMB);
+	FParse::Value(*Params, TEXT("DialogueWidget="), DialogueWidgetPath);
+	FParse::Value(*Params, TEXT("InteractWidget="), InteractWidgetPath);
+	FParse::Value(*Params, TEXT("IndicatorClass="), IndicatorClassPath);
+	NumTriggers = FMath::Max(NumTriggers, 1);
+	Interval = FMath::Max(Interval, 1);
+	NumLines = FMath::Max(NumLines, 1);
+
+	UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+	GameInstance->AddToRoot();
+	GameInstance->InitializeStandalone(FName("DialogueSoakWorld"));
+	World = GameInstance->GetWorld();
+	World->InitializeActorsForPlay(FURL());
+	World->GetWorldSettings()->NotifyBeginPlay();
+
+	// Without widget classes the soak test only covers the triggers, the manager and the subsystem
+	TArray<UUserWidget*> Widgets;
+	UClass* DialogueWidgetClass = DialogueWidgetPath.IsEmpty() ? nullptr : LoadClass<UDialogueWidget>(nullptr, *DialogueWidgetPath);
+	UClass* InteractWidgetClass = InteractWidgetPath.IsEmpty() ? nullptr : LoadClass<UDialogueInteractWidget>(nullptr, *InteractWidgetPath);
+	IndicatorClass = IndicatorClassPath.IsEmpty() ? nullptr : LoadClass<UInputIndicatorWidget>(nullptr, *IndicatorClassPath);
+	for (UClass* WidgetClass : {DialogueWidgetClass, InteractWidgetClass})
+	{
+		if (WidgetClass == nullptr)
+		{
+			ULog::Warning("DialogueSoakCommandlet::Main", "Widget class not set. Widgets are not soak tested");
+			continue;
+		}
+
+		UUserWidget* Widget = CreateWidget<UUserWidget>(GameInstance, WidgetClass);
+		Widget->AddToRoot();
+		if (UDialogueWidget* DialogueWidget = Cast<UDialogueWidget>(Widget))
+		{
+			DialogueWidget->InputDebounceTime = 0.0f;
+		}
+
+		Widgets.Add(Widget);
+	}
+
+	Player = World->SpawnActor<AActor>();
+	DialogueManager = World->SpawnActor<ADialogueManager>();
+	for (int TriggerIndex = 0; TriggerIndex < NumTriggers; TriggerIndex++)
+	{
+		TriggerActors.Add(SpawnTrigger(TriggerIndex));
+	}
+
+	int BaselineObjects = 0;
+	int64 BaselineMemory = 0;
+	bool GrowthDetected = false;
+	double IntervalStart = FPlatformTime::Seconds();
+	for (int Cycle = 0; Cycle < NumCycles; Cycle++)
+	{
+		RunCycle(Cycle);
+		if ((Cycle + 1) % Interval != 0 && Cycle + 1 != NumCycles)
+		{
+			continue;
+		}
+
+		const double CycleMilliseconds = (FPlatformTime::Seconds() - IntervalStart) * 1000.0 / Interval;
+		const double GCStart = FPlatformTime::Seconds();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+		const double GCMilliseconds = (FPlatformTime::Seconds() - GCStart) * 1000.0;
+
+		const int NumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		const int64 UsedMemory = static_cast<int64>(MemoryStats.UsedPhysical);
+
+		// The first interval warms up the caches and pools, so it is used as the baseline
+		if (Cycle + 1 <= Interval)
+		{
+			BaselineObjects = NumObjects;
+			BaselineMemory = UsedMemory;
+		}
+
+		const int ObjectGrowth = NumObjects - BaselineObjects;
+		const double MemoryGrowthMB = (UsedMemory - BaselineMemory) / (1024.0 * 1024.0);
+		ULog::Info("DialogueSoakCommandlet::Main", FString::Printf(
+			TEXT("Cycles = %d, Objects = %d (%+d), Used = %.1f MB (%+.1f MB), Peak = %.1f MB, GC = %.2f ms, ")
+			TEXT("Cycle = %.3f ms"), Cycle + 1, NumObjects, ObjectGrowth, UsedMemory / (1024.0 * 1024.0),
+			MemoryGrowthMB, MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0), GCMilliseconds, CycleMilliseconds));
+
+		if (ObjectGrowth > MaxObjectGrowth || MemoryGrowthMB > MaxMemoryGrowthMB)
+		{
+			ULog::Error("DialogueSoakCommandlet::Main", "Growth detected since the first interval");
+			GrowthDetected = true;
+		}
+
+		IntervalStart = FPlatformTime::Seconds();
+	}
+
+	for (UUserWidget* Widget : Widgets)
+	{
+		Widget->RemoveFromRoot();
+	}
+
+	TriggerActors.Empty();
+	GameInstance->Shutdown();
+	GameInstance->RemoveFromRoot();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+	return GrowthDetected ? 1 : 0;
+}
+
+/**
+ * @brief Spawn an actor with a dialogue trigger. The trigger registers with the dialogue manager
+ * @param TriggerIndex The index of the trigger
+ * @return The actor that owns the trigger
+ */
+AActor* UDialogueSoakCommandlet::SpawnTrigger(const int TriggerIndex)
+{
+	AActor* Actor = World->SpawnActor<AActor>();
+	UDialogueTrigger* Trigger = NewObject<UDialogueTrigger>(Actor);
+	Trigger->ConversationId = FName("DialogueSoak", TriggerIndex + 1);
+	Trigger->PlayerClass = Player->GetClass();
+	Trigger->InputIndicatorWidgetClass = IndicatorClass;
+	for (int Line = 0; Line < NumLines; Line++)
+	{
+		Trigger->DialogueTitles.Add(FText::FromString("Soak"));
+		Trigger->DialogueMessages.Add(FText::FromString(FString::Printf(TEXT("Soak line %d"), Line)));
+		Trigger->DialogueVoices.Add(nullptr);
+	}
+
+	Actor->AddInstanceComponent(Trigger);
+	Trigger->RegisterComponent();
+	return Actor;
+}
+
+/**
+ * @brief Run a single enter, show, skip, dismiss and exit cycle
+ * @param Cycle The index of the cycle
+ */
+void UDialogueSoakCommandlet::RunCycle(const int Cycle)
+{
+	const int TriggerIndex = Cycle % TriggerActors.Num();
+	AActor* TriggerActor = TriggerActors[TriggerIndex];
+
+	TriggerActor->OnActorBeginOverlap.Broadcast(TriggerActor, Player);
+	DialogueManager->ShowDialogue();
+	for (int Step = 0; DialogueManager->IsDialogueShown() && Step < NumLines * 2 + 2; Step++)
+	{
+		// The dialogue widget applies one skip input per frame
+		GFrameCounter++;
+		DialogueManager->SkipDialogueMessage();
+	}
+
+	if (DialogueManager->IsDialogueShown())
+	{
+		DialogueManager->OnDialogueDismissed();
+	}
+
+	TriggerActor->OnActorEndOverlap.Broadcast(TriggerActor, Player);
+
+	// Every cycle streams one trigger out and back in to cover the registration churn of an open world
+	TriggerActor->Destroy();
+	TriggerActors[TriggerIndex] = SpawnTrigger(TriggerIndex);
+}
\ No newline at end of file
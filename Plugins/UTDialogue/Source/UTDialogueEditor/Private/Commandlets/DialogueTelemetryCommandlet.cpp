@@ -0,0 +1,94 @@
+﻿#include "Commandlets/DialogueTelemetryCommandlet.h"
+#include "Core/DialogueTelemetry.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Core/Log.h"
+
+UDialogueTelemetryCommandlet::UDialogueTelemetryCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+/**
+ * @brief Run the commandlet
+ * @param Params The command line parameters
+ * @return 0 if all the logs were converted or 1 if a log could not be converted
+ */
+int32 UDialogueTelemetryCommandlet::Main(const FString& Params)
+{
+	FString InputPath = FPaths::ProjectSavedDir() / TEXT("Telemetry");
+	FString OutputPath;
+	FParse::Value(*Params, TEXT("Input="), InputPath);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	// A directory is converted log by log and the CSV files are written next to the logs
+	if (IFileManager::Get().DirectoryExists(*InputPath))
+	{
+		TArray<FString> LogNames;
+		IFileManager::Get().FindFiles(LogNames, *(InputPath / TEXT("*.utdt")), true, false);
+		if (LogNames.Num() == 0)
+		{
+			ULog::Warning("DialogueTelemetryCommandlet::Main", FString("No telemetry logs found in ").Append(InputPath));
+			return 0;
+		}
+
+		int NumFailed = 0;
+		for (const FString& LogName : LogNames)
+		{
+			const FString LogPath = InputPath / LogName;
+			NumFailed += ConvertLog(LogPath, FPaths::ChangeExtension(LogPath, TEXT("csv"))) ? 0 : 1;
+		}
+
+		return NumFailed == 0 ? 0 : 1;
+	}
+
+	return ConvertLog(InputPath, OutputPath.IsEmpty() ? FPaths::ChangeExtension(InputPath, TEXT("csv")) : OutputPath)
+		? 0
+		: 1;
+}
+
+/**
+ * @brief Convert a telemetry log to a CSV file
+ * @param InputPath The path of the log file
+ * @param OutputPath The path of the CSV file
+ * @return A boolean value indicating if the log was converted
+ */
+bool UDialogueTelemetryCommandlet::ConvertLog(const FString& InputPath, const FString& OutputPath)
+{
+	TArray<FDialogueTelemetryRecord> Records;
+	TMap<uint32, FString> Names;
+	const bool Complete = FDialogueTelemetry::ReadLog(InputPath, Records, Names);
+	if (!Complete && Records.Num() == 0)
+	{
+		return false;
+	}
+
+	// Every thread writes its own buffers so the records are only ordered within a buffer
+	Records.StableSort([](const FDialogueTelemetryRecord& A, const FDialogueTelemetryRecord& B)
+	{
+		return A.Time < B.Time;
+	});
+
+	FString Csv = TEXT("Time,Event,ConversationId,Conversation,Line,Value\n");
+	for (const FDialogueTelemetryRecord& Record : Records)
+	{
+		const FString* Name = Names.Find(Record.Conversation);
+		Csv += FString::Printf(TEXT("%u,%s,%08x,%s,%u,%u\n"), Record.Time,
+			FDialogueTelemetry::GetEventName(Record.Event), Record.Conversation, Name != nullptr ? **Name : TEXT(""),
+			Record.Line, Record.Value);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *OutputPath))
+	{
+		ULog::Error("DialogueTelemetryCommandlet::ConvertLog", FString("Unable to write ").Append(OutputPath));
+		return false;
+	}
+
+	ULog::Info("DialogueTelemetryCommandlet::ConvertLog", FString::Printf(TEXT("%d events written to %s"),
+		Records.Num(), *OutputPath));
+	return Complete;
+}
\ No newline at end of file
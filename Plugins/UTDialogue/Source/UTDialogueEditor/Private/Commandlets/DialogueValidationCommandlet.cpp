@@ -0,0 +1,291 @@
+﻿#include "Commandlets/DialogueValidationCommandlet.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Audio/DialogueVoiceList.h"
+#include "Components/DialogueTrigger.h"
+#include "Engine/Blueprint.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "Misc/DataValidation.h"
+#include "Core/Log.h"
+
+UDialogueValidationCommandlet::UDialogueValidationCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+	ShowErrorCount = true;
+	BatchSize = 64;
+	NumValidated = 0;
+	NumErrors = 0;
+}
+
+/**
+ * @brief Run the commandlet
+ * @param Params The command line parameters
+ * @return 0 if all the dialogue data is valid or 1 if errors were found
+ */
+int32 UDialogueValidationCommandlet::Main(const FString& Params)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	TMap<FString, FString> ParamValues;
+	ParseCommandLine(*Params, Tokens, Switches, ParamValues);
+
+	const FString* PathsParam = ParamValues.Find(TEXT("Paths"));
+	if (PathsParam == nullptr || PathsParam->ParseIntoArray(Paths, TEXT("+")) == 0)
+	{
+		Paths = {TEXT("/Game/")};
+	}
+
+	const FString* BatchSizeParam = ParamValues.Find(TEXT("BatchSize"));
+	BatchSize = BatchSizeParam != nullptr ? FMath::Max(FCString::Atoi(**BatchSizeParam), 1) : BatchSize;
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	const TArray<FName> PackageNames = FindPackages(AssetRegistry, Switches.Contains(TEXT("AllMaps")));
+	ULog::Info("DialogueValidationCommandlet::Main",
+		FString("Validating packages = ").Append(FString::FromInt(PackageNames.Num())));
+
+	TArray<FName> Batch;
+	for (const FName PackageName : PackageNames)
+	{
+		Batch.Add(PackageName);
+		if (Batch.Num() >= BatchSize)
+		{
+			ValidateBatch(Batch);
+			Batch.Reset();
+		}
+	}
+
+	ValidateBatch(Batch);
+
+	ULog::Info("DialogueValidationCommandlet::Main", FString::Printf(
+		TEXT("Validated %d objects in %d packages in %.2f seconds. Errors = %d"), NumValidated, PackageNames.Num(),
+		FPlatformTime::Seconds() - StartTime, NumErrors));
+	return NumErrors > 0 ? 1 : 0;
+}
+
+/**
+ * @brief Find the packages that can contain dialogue data
+ * @param AssetRegistry The asset registry used to find the packages
+ * @param AllMaps Should every map be loaded instead of only the maps that reference the dialogue classes?
+ * @return The names of the packages that can contain dialogue data
+ */
+TArray<FName> UDialogueValidationCommandlet::FindPackages(const IAssetRegistry& AssetRegistry, const bool AllMaps) const
+{
+	const FString ExternalActorsFolder = FString("/").Append(ULevel::GetExternalActorsFolderName()).Append("/");
+	const FString VoiceListPath = UDialogueVoiceList::StaticClass()->GetPathName();
+	TSet<FName> PackageNames;
+
+	// Only the packages that directly or indirectly import the dialogue classes need to be loaded
+	TSet<FName> Referencers;
+	TArray<FName> Pending = {UDialogueTrigger::StaticClass()->GetOutermost()->GetFName()};
+	while (Pending.Num() > 0)
+	{
+		TArray<FName> DirectReferencers;
+		AssetRegistry.GetReferencers(Pending.Pop(false), DirectReferencers);
+		for (const FName Referencer : DirectReferencers)
+		{
+			bool AlreadyFound;
+			Referencers.Add(Referencer, &AlreadyFound);
+			if (!AlreadyFound)
+			{
+				Pending.Add(Referencer);
+			}
+		}
+	}
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssetsByClass(UWorld::StaticClass()->GetFName(), Assets);
+	for (const FAssetData& Asset : Assets)
+	{
+		if (AllMaps || Referencers.Contains(Asset.PackageName))
+		{
+			PackageNames.Add(Asset.PackageName);
+		}
+	}
+
+	for (const FName Referencer : Referencers)
+	{
+		// World partition maps store their actors in separate packages that are not loaded with the map
+		if (Referencer.ToString().Contains(ExternalActorsFolder))
+		{
+			PackageNames.Add(Referencer);
+		}
+	}
+
+	Assets.Reset();
+	AssetRegistry.GetAssetsByClass(UDialogueVoiceList::StaticClass()->GetFName(), Assets, true);
+	AssetRegistry.GetAssetsByClass(UBlueprint::StaticClass()->GetFName(), Assets);
+	for (const FAssetData& Asset : Assets)
+	{
+		FString ParentClass;
+		if (Asset.AssetClass != UBlueprint::StaticClass()->GetFName()
+			|| (Asset.GetTagValue(FBlueprintTags::NativeParentClassPath, ParentClass) && ParentClass.Contains(VoiceListPath)))
+		{
+			PackageNames.Add(Asset.PackageName);
+		}
+	}
+
+	TArray<FName> Result;
+	for (const FName PackageName : PackageNames)
+	{
+		if (IsInPaths(PackageName))
+		{
+			Result.Add(PackageName);
+		}
+	}
+
+	Result.Sort(FNameLexicalLess());
+	return Result;
+}
+
+/**
+ * @brief Check if the specified package is in one of the validated paths
+ * @param PackageName The name of the package
+ * @return A boolean value indicating if the package is in one of the validated paths
+ */
+bool UDialogueValidationCommandlet::IsInPaths(const FName PackageName) const
+{
+	const FString Name = PackageName.ToString();
+	for (const FString& Path : Paths)
+	{
+		if (Name.StartsWith(Path))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief Load the specified packages in parallel and validate them
+ * @param PackageNames The names of the packages to load
+ */
+void UDialogueValidationCommandlet::ValidateBatch(const TArray<FName>& PackageNames)
+{
+	if (PackageNames.Num() == 0)
+	{
+		return;
+	}
+
+	// Only the names are kept while loading. A package pointer from a completion callback is not referenced by
+	// anything until the whole batch is loaded, so the packages are found again after the flush
+	TArray<FName> LoadedPackageNames;
+	for (const FName PackageName : PackageNames)
+	{
+		LoadPackageAsync(PackageName.ToString(), FLoadPackageAsyncDelegate::CreateLambda(
+			[this, &LoadedPackageNames](const FName& LoadedName, UPackage* Package,
+				const EAsyncLoadingResult::Type Result)
+			{
+				if (Result != EAsyncLoadingResult::Succeeded || Package == nullptr)
+				{
+					ULog::Error("DialogueValidationCommandlet::ValidateBatch",
+						FString("Failed to load ").Append(LoadedName.ToString()));
+					NumErrors++;
+					return;
+				}
+
+				LoadedPackageNames.Add(LoadedName);
+			}));
+	}
+
+	FlushAsyncLoading();
+
+	for (const FName LoadedName : LoadedPackageNames)
+	{
+		UPackage* Package = FindPackage(nullptr, *LoadedName.ToString());
+		if (Package == nullptr)
+		{
+			ULog::Error("DialogueValidationCommandlet::ValidateBatch",
+				FString("Package was unloaded before it was validated: ").Append(LoadedName.ToString()));
+			NumErrors++;
+			continue;
+		}
+
+		ValidatePackage(Package);
+	}
+
+	CollectGarbage(RF_NoFlags);
+}
+
+/**
+ * @brief Validate all the dialogue data in a loaded package
+ * @param Package The loaded package
+ */
+void UDialogueValidationCommandlet::ValidatePackage(UPackage* Package)
+{
+	ForEachObjectWithPackage(Package, [this](UObject* Object)
+	{
+		if (UDialogueTrigger* Trigger = Cast<UDialogueTrigger>(Object))
+		{
+			if (Trigger->IsTemplate())
+			{
+				return true;
+			}
+
+			const FString Name = Trigger->GetFullName();
+			ValidateObject(Trigger, Name);
+
+			const FString* FirstTrigger = Trigger->ConversationId.IsNone()
+				? nullptr
+				: ConversationIds.Find(Trigger->ConversationId);
+			if (FirstTrigger != nullptr)
+			{
+				ULog::Error("DialogueValidationCommandlet::ValidatePackage", FString::Printf(
+					TEXT("%s: ConversationId %s is already used by %s"), *Name,
+					*Trigger->ConversationId.ToString(), **FirstTrigger));
+				NumErrors++;
+			}
+			else if (!Trigger->ConversationId.IsNone())
+			{
+				ConversationIds.Add(Trigger->ConversationId, Name);
+			}
+		}
+		else if (const UBlueprint* Blueprint = Cast<UBlueprint>(Object))
+		{
+			if (Blueprint->GeneratedClass != nullptr && Blueprint->GeneratedClass->IsChildOf<UDialogueVoiceList>())
+			{
+				ValidateObject(Blueprint->GeneratedClass->GetDefaultObject(), Blueprint->GetPathName());
+			}
+		}
+		else if (UDialogueVoiceList* VoiceList = Cast<UDialogueVoiceList>(Object))
+		{
+			if (!VoiceList->IsTemplate())
+			{
+				ValidateObject(VoiceList, VoiceList->GetPathName());
+			}
+		}
+
+		return true;
+	});
+}
+
+/**
+ * @brief Validate an object and report the errors
+ * @param Object The object to validate
+ * @param Name The name used when reporting errors
+ */
+void UDialogueValidationCommandlet::ValidateObject(UObject* Object, const FString& Name)
+{
+	NumValidated++;
+
+	TArray<FText> ValidationErrors;
+	if (Object->IsDataValid(ValidationErrors) != EDataValidationResult::Invalid)
+	{
+		return;
+	}
+
+	for (const FText& Error : ValidationErrors)
+	{
+		ULog::Error("DialogueValidationCommandlet::ValidateObject",
+			FString::Printf(TEXT("%s: %s"), *Name, *Error.ToString()));
+	}
+
+	NumErrors += FMath::Max(ValidationErrors.Num(), 1);
+}
\ No newline at end of file
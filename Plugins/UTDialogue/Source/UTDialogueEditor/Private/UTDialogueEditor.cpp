@@ -0,0 +1,15 @@
+#include "UTDialogueEditor.h"
+
+#define LOCTEXT_NAMESPACE "FUTDialogueEditorModule"
+
+void FUTDialogueEditorModule::StartupModule()
+{
+}
+
+void FUTDialogueEditorModule::ShutdownModule()
+{
+}
+
+#undef LOCTEXT_NAMESPACE
+	
+IMPLEMENT_MODULE(FUTDialogueEditorModule, UTDialogueEditor)
\ No newline at end of file
@@ -0,0 +1,80 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueSoakCommandlet.generated.h"
+
+class ADialogueManager;
+class UDialogueTrigger;
+
+/**
+ * @brief Drives a simulated player through thousands of enter, show, skip, dismiss and exit cycles and fails when
+ * the number of objects or the memory keeps growing.
+ * Usage: UnrealEditor-Cmd Project.uproject -run=DialogueSoak [-Cycles=10000] [-Triggers=64] [-Interval=1000]
+ * [-Lines=3] [-DialogueWidget=Class] [-InteractWidget=Class] [-IndicatorClass=Class] [-MaxObjectGrowth=0]
+ * [-MaxMemoryGrowthMB=16]
+ */
+UCLASS()
+class UTDIALOGUEEDITOR_API UDialogueSoakCommandlet final : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueSoakCommandlet();
+
+	/**
+	 * @brief Run the commandlet
+	 * @param Params The command line parameters
+	 * @return 0 if no growth was detected or 1 if the soak test failed
+	 */
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/**
+	 * @brief The world used to spawn the triggers
+	 */
+	UPROPERTY()
+	UWorld* World;
+
+	/**
+	 * @brief The actor used as the simulated player
+	 */
+	UPROPERTY()
+	AActor* Player;
+
+	/**
+	 * @brief The dialogue manager of the soak world
+	 */
+	UPROPERTY()
+	ADialogueManager* DialogueManager;
+
+	/**
+	 * @brief The actors that own the dialogue triggers
+	 */
+	UPROPERTY()
+	TArray<AActor*> TriggerActors;
+
+	/**
+	 * @brief The input indicator class used by every trigger
+	 */
+	UPROPERTY()
+	UClass* IndicatorClass;
+
+	/**
+	 * @brief The number of lines in every conversation
+	 */
+	int NumLines;
+
+	/**
+	 * @brief Spawn an actor with a dialogue trigger. The trigger registers with the dialogue manager
+	 * @param TriggerIndex The index of the trigger
+	 * @return The actor that owns the trigger
+	 */
+	AActor* SpawnTrigger(int TriggerIndex);
+
+	/**
+	 * @brief Run a single enter, show, skip, dismiss and exit cycle
+	 * @param Cycle The index of the cycle
+	 */
+	void RunCycle(int Cycle);
+};
\ No newline at end of file
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueTelemetryCommandlet.generated.h"
+
+/**
+ * @brief Converts dialogue telemetry logs to CSV files. Every log in the input directory is converted when the input
+ * is a directory.
+ * Usage: UnrealEditor-Cmd Project.uproject -run=DialogueTelemetry [-Input=Saved/Telemetry] [-Output=Path.csv]
+ */
+UCLASS()
+class UTDIALOGUEEDITOR_API UDialogueTelemetryCommandlet final : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueTelemetryCommandlet();
+
+	/**
+	 * @brief Run the commandlet
+	 * @param Params The command line parameters
+	 * @return 0 if all the logs were converted or 1 if a log could not be converted
+	 */
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/**
+	 * @brief Convert a telemetry log to a CSV file
+	 * @param InputPath The path of the log file
+	 * @param OutputPath The path of the CSV file
+	 * @return A boolean value indicating if the log was converted
+	 */
+	static bool ConvertLog(const FString& InputPath, const FString& OutputPath);
+};
\ No newline at end of file
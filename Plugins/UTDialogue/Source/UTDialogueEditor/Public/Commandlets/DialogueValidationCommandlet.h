@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DialogueValidationCommandlet.generated.h"
+
+class IAssetRegistry;
+
+/**
+ * @brief Validates every dialogue trigger in all the maps and every dialogue voice list without starting the game.
+ * Usage: UnrealEditor-Cmd Project.uproject -run=DialogueValidation [-Paths=/Game+/Other] [-BatchSize=64] [-AllMaps]
+ */
+UCLASS()
+class UTDIALOGUEEDITOR_API UDialogueValidationCommandlet final : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDialogueValidationCommandlet();
+
+	/**
+	 * @brief Run the commandlet
+	 * @param Params The command line parameters
+	 * @return 0 if all the dialogue data is valid or 1 if errors were found
+	 */
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/**
+	 * @brief The root paths of the packages that are validated
+	 */
+	TArray<FString> Paths;
+
+	/**
+	 * @brief The number of packages loaded in parallel before they are validated and released
+	 */
+	int BatchSize;
+
+	/**
+	 * @brief The number of objects that were validated
+	 */
+	int NumValidated;
+
+	/**
+	 * @brief The number of errors that were found
+	 */
+	int NumErrors;
+
+	/**
+	 * @brief The path of the first trigger using every explicit conversation ID. Used to find duplicate IDs
+	 */
+	TMap<FName, FString> ConversationIds;
+
+	/**
+	 * @brief Find the packages that can contain dialogue data
+	 * @param AssetRegistry The asset registry used to find the packages
+	 * @param AllMaps Should every map be loaded instead of only the maps that reference the dialogue classes?
+	 * @return The names of the packages that can contain dialogue data
+	 */
+	TArray<FName> FindPackages(const IAssetRegistry& AssetRegistry, bool AllMaps) const;
+
+	/**
+	 * @brief Check if the specified package is in one of the validated paths
+	 * @param PackageName The name of the package
+	 * @return A boolean value indicating if the package is in one of the validated paths
+	 */
+	bool IsInPaths(FName PackageName) const;
+
+	/**
+	 * @brief Load the specified packages in parallel and validate them
+	 * @param PackageNames The names of the packages to load
+	 */
+	void ValidateBatch(const TArray<FName>& PackageNames);
+
+	/**
+	 * @brief Validate all the dialogue data in a loaded package
+	 * @param Package The loaded package
+	 */
+	void ValidatePackage(UPackage* Package);
+
+	/**
+	 * @brief Validate an object and report the errors
+	 * @param Object The object to validate
+	 * @param Name The name used when reporting errors
+	 */
+	void ValidateObject(UObject* Object, const FString& Name);
+};
\ No newline at end of file
@@ -0,0 +1,16 @@
+using UnrealBuildTool;
+
+public class UTDialogueEditor : ModuleRules
+{
+	public UTDialogueEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+		PublicIncludePaths.AddRange(new string[] { });
+		PrivateIncludePaths.AddRange(new string[] { });
+		PublicDependencyModuleNames.AddRange(new string[]
+			{"Core", "CoreUObject", "Engine", "UTDialogue"});
+		PrivateDependencyModuleNames.AddRange(new string[]
+			{"AssetRegistry", "UMG", "UTInputIndicator", "UTLogger"});
+		DynamicallyLoadedModuleNames.AddRange(new string[] { });
+	}
+}
\ No newline at end of file